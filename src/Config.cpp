@@ -77,6 +77,7 @@ public:
     bool m_dropIndicatorsInhibited = false;
     bool m_layoutSaverStrictMode = false;
     bool m_onlyProgrammaticDrag = false;
+    int m_separatorMoveInterval = 0;
 };
 
 Config::Config()
@@ -441,4 +442,45 @@ bool Config::onlyProgrammaticDrag() const
     return d->m_onlyProgrammaticDrag;
 }
 
+void Config::setSeparatorMoveInterval(int ms)
+{
+    d->m_separatorMoveInterval = std::max(0, ms);
+}
+
+int Config::separatorMoveInterval() const
+{
+    return d->m_separatorMoveInterval;
+}
+
+void Config::setSanityCheckPolicy(SanityCheckPolicy policy, int sampleInterval)
+{
+    if (sampleInterval < 1) {
+        KDDW_ERROR("Config::setSanityCheckPolicy: Invalid sample interval {}", sampleInterval);
+        sampleInterval = 1;
+    }
+
+    Item::s_sanityCheckPolicy = policy;
+    Item::s_sanityCheckSampleInterval = sampleInterval;
+}
+
+SanityCheckPolicy Config::sanityCheckPolicy() const
+{
+    return Item::s_sanityCheckPolicy;
+}
+
+int Config::sanityCheckSampleInterval() const
+{
+    return Item::s_sanityCheckSampleInterval;
+}
+
+void Config::resetSanityCheckViolations()
+{
+    Item::resetSanityViolations();
+}
+
+int Config::numSanityCheckViolations() const
+{
+    return Item::numSanityViolations();
+}
+
 }
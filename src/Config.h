@@ -411,6 +411,32 @@ public:
     void setOnlyProgrammaticDrag(bool);
     bool onlyProgrammaticDrag() const;
 
+    /// Coalesces separator moves. While dragging a separator, the layout is updated at most once
+    /// every @p ms milliseconds, with the latest mouse position. Useful with high polling rate mice
+    /// and docks which are expensive to resize. 16 is about one update per frame at 60Hz.
+    /// The final position is always applied when the mouse is released.
+    /// Default is 0, every mouse move updates the layout. Has no effect with Flag_LazyResize.
+    void setSeparatorMoveInterval(int ms);
+    int separatorMoveInterval() const;
+
+    /// Sets how much the layouting engine verifies itself.
+    /// With SanityCheckPolicy::Sampled, checks which visit the whole layout, like the one done
+    /// before each LayoutSaver::serializeLayout(), only run once every @p sampleInterval times,
+    /// which suits production builds which save often.
+    /// Cheap per-item checks still run and violations are still counted.
+    /// With SanityCheckPolicy::Off nothing is checked.
+    /// Default is SanityCheckPolicy::Full.
+    /// @sa numSanityCheckViolations()
+    void setSanityCheckPolicy(SanityCheckPolicy, int sampleInterval = 10);
+    SanityCheckPolicy sanityCheckPolicy() const;
+    int sanityCheckSampleInterval() const;
+
+    /// Returns how many sanity check violations were detected so far, useful for telemetry.
+    int numSanityCheckViolations() const;
+
+    /// Resets numSanityCheckViolations() to 0.
+    void resetSanityCheckViolations();
+
 private:
     KDDW_DELETE_COPY_CTOR(Config)
     Config();
@@ -245,6 +245,21 @@ enum RestoreOption {
 Q_DECLARE_FLAGS(RestoreOptions, RestoreOption)
 Q_ENUM_NS(RestoreOptions)
 
+///@brief The format LayoutSaver serializes layouts to. Restoring supports all of them.
+enum class LayoutSaverFormat {
+    Json = 0, ///< Human readable and pretty printed. The default.
+    Cbor ///< Compact binary encoding (RFC 8949) of the same document. Faster to save and restore.
+};
+Q_ENUM_NS(LayoutSaverFormat)
+
+///@brief How much the layouting engine verifies itself. See Config::setSanityCheckPolicy()
+enum class SanityCheckPolicy {
+    Full = 0, ///< Every check runs. The default.
+    Sampled, ///< Cheap checks run, but only 1 in N full layout checks do.
+    Off ///< Nothing is checked, violations aren't counted either.
+};
+Q_ENUM_NS(SanityCheckPolicy)
+
 enum class DropIndicatorType {
     Classic, ///< The default
     Segmented, ///< Segmented indicators
@@ -390,6 +405,9 @@ void DOCKS_EXPORT initFrontend(FrontendType);
 
 /// Returns the name of the logger used by KDDW
 /// You can pass this name to spdlog::get() and change log level
+/// To use your own logger, register it with this name before KDDW logs anything, for example
+/// before calling initFrontend(). The logger is looked up only once, so registering or replacing
+/// it later has no effect.
 DOCKS_EXPORT const char *spdlogLoggerName();
 
 #ifdef KDDW_FRONTEND_QTWIDGETS
@@ -32,13 +32,24 @@
 #include "core/FloatingWindow.h"
 #include "core/DockWidget.h"
 #include "core/DockWidget_p.h"
+#include "core/Group_p.h"
 #include "core/MainWindow.h"
+#include "core/MainWindow_p.h"
+#include "core/SideBar.h"
 #include "core/nlohmann_helpers_p.h"
+#include "core/LayoutSchemaValidator_p.h"
 #include "core/layouting/Item_p.h"
+#include "core/layouting/LayoutingHost_p.h"
+#include "core/layouting/LayoutingSeparator_p.h"
 
 #include <iostream>
 #include <fstream>
 #include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <unordered_set>
 #include <utility>
 
 /**
@@ -91,6 +102,11 @@ inline InternalRestoreOptions internalRestoreOptions(RestoreOptions options)
 
 bool LayoutSaver::Private::s_restoreInProgress = false;
 
+namespace {
+/// The dock widgets of the layout being prepared in the current thread, see prepareLayout()
+thread_local std::map<QString, LayoutSaver::DockWidget::Ptr> *t_dockWidgetsBeingPrepared = nullptr;
+}
+
 namespace KDDockWidgets {
 
 template<typename T>
@@ -371,6 +387,516 @@ void from_json(const nlohmann::json &json, typename LayoutSaver::DockWidget::Lis
 
 }
 
+namespace {
+
+/// Writes JSON incrementally, instead of building a nlohmann::json DOM and dumping it.
+/// Output is buffered and handed to the sink in chunks. It's the same as nlohmann::json::dump(4),
+/// provided object members are written sorted by key, as nlohmann::json sorts them.
+class JsonStreamWriter
+{
+public:
+    using Sink = std::function<void(const char *, std::size_t)>;
+
+    explicit JsonStreamWriter(Sink sink)
+        : m_sink(std::move(sink))
+    {
+        m_buffer.reserve(s_chunkSize);
+    }
+
+    void beginObject()
+    {
+        beginValue();
+        m_buffer += '{';
+        m_scopeIsEmpty.push_back(true);
+    }
+
+    void endObject()
+    {
+        endScope('}');
+    }
+
+    void beginArray()
+    {
+        beginValue();
+        m_buffer += '[';
+        m_scopeIsEmpty.push_back(true);
+    }
+
+    void endArray()
+    {
+        endScope(']');
+    }
+
+    /// Starts a member of the current object, must be followed by its value
+    void key(const std::string &name)
+    {
+        beginElement();
+        m_buffer += nlohmann::json(name).dump();
+        m_buffer += ": ";
+        m_keyWritten = true;
+    }
+
+    /// Writes @p value. Containers are walked, not copied.
+    void value(const nlohmann::json &value)
+    {
+        if (value.is_object()) {
+            beginObject();
+            for (auto it = value.cbegin(); it != value.cend(); ++it) {
+                key(it.key());
+                this->value(*it);
+            }
+            endObject();
+        } else if (value.is_array()) {
+            beginArray();
+            for (const auto &element : value)
+                this->value(element);
+            endArray();
+        } else {
+            beginValue();
+            m_buffer += value.dump();
+            flushIfNeeded();
+        }
+    }
+
+    /// Convenience for small members, they're converted via their to_json()
+    template<typename T>
+    void member(const char *name, const T &value)
+    {
+        key(name);
+        this->value(nlohmann::json(value));
+    }
+
+    void flush()
+    {
+        if (!m_buffer.empty()) {
+            m_sink(m_buffer.data(), m_buffer.size());
+            m_buffer.clear();
+        }
+    }
+
+private:
+    void beginValue()
+    {
+        if (m_keyWritten) {
+            m_keyWritten = false;
+        } else if (!m_scopeIsEmpty.empty()) {
+            beginElement(); // array element
+        }
+    }
+
+    void beginElement()
+    {
+        if (!m_scopeIsEmpty.back())
+            m_buffer += ',';
+        m_scopeIsEmpty.back() = false;
+        m_buffer += '\n';
+        m_buffer.append(m_scopeIsEmpty.size() * s_indent, ' ');
+    }
+
+    void endScope(char c)
+    {
+        const bool isEmpty = m_scopeIsEmpty.back();
+        m_scopeIsEmpty.pop_back();
+        if (!isEmpty) {
+            m_buffer += '\n';
+            m_buffer.append(m_scopeIsEmpty.size() * s_indent, ' ');
+        }
+        m_buffer += c;
+        flushIfNeeded();
+    }
+
+    void flushIfNeeded()
+    {
+        if (m_buffer.size() >= s_chunkSize)
+            flush();
+    }
+
+    static constexpr std::size_t s_chunkSize = 64 * 1024;
+    static constexpr std::size_t s_indent = 4;
+
+    const Sink m_sink;
+    std::string m_buffer;
+    std::vector<bool> m_scopeIsEmpty;
+    bool m_keyWritten = false;
+};
+
+// The writeJson() overloads below are the streaming counterparts of to_json(). Members are written
+// in alphabetical order, so the result is the same as dumping the DOM. Small structs are still
+// converted via to_json(), it's the item layouts and the lists of windows which are big.
+
+void writeJson(JsonStreamWriter &writer, const LayoutSaver::MultiSplitter &s)
+{
+    writer.beginObject();
+
+    writer.key("frames");
+    if (s.groups.empty()) {
+        writer.value(nullptr);
+    } else {
+        std::vector<std::pair<std::string, const LayoutSaver::Group *>> groups;
+        groups.reserve(s.groups.size());
+        for (const auto &it : s.groups)
+            groups.emplace_back(it.second.id.toStdString(), &it.second);
+        std::sort(groups.begin(), groups.end());
+
+        writer.beginObject();
+        for (const auto &it : groups)
+            writer.member(it.first.c_str(), *it.second);
+        writer.endObject();
+    }
+
+    writer.key("layout");
+    writer.value(s.layout);
+
+    writer.endObject();
+}
+
+void writeJson(JsonStreamWriter &writer, const LayoutSaver::MainWindow &mw)
+{
+    writer.beginObject();
+    writer.member("affinities", mw.affinities);
+    writer.member("geometry", mw.geometry);
+    writer.member("isVisible", mw.isVisible);
+    writer.key("multiSplitterLayout");
+    writeJson(writer, mw.multiSplitterLayout);
+    writer.member("normalGeometry", mw.normalGeometry);
+    writer.member("options", int(mw.options));
+    writer.member("screenIndex", mw.screenIndex);
+    writer.member("screenSize", mw.screenSize);
+
+    for (SideBarLocation loc : { SideBarLocation::North, SideBarLocation::East,
+                                 SideBarLocation::West, SideBarLocation::South }) {
+        const Vector<QString> dockWidgets = mw.dockWidgetsForSideBar(loc);
+        if (!dockWidgets.isEmpty()) {
+            std::string key = std::string("sidebar-") + std::to_string(( int )loc);
+            writer.member(key.c_str(), dockWidgets);
+        }
+    }
+
+    writer.member("uniqueName", mw.uniqueName);
+    writer.member("windowState", mw.windowState);
+    writer.endObject();
+}
+
+void writeJson(JsonStreamWriter &writer, const LayoutSaver::FloatingWindow &window)
+{
+    writer.beginObject();
+    if (!window.affinities.isEmpty())
+        writer.member("affinities", window.affinities);
+    writer.member("flags", window.flags);
+    writer.member("geometry", window.geometry);
+    writer.member("isVisible", window.isVisible);
+    writer.key("multiSplitterLayout");
+    writeJson(writer, window.multiSplitterLayout);
+    writer.member("normalGeometry", window.normalGeometry);
+    writer.member("parentIndex", window.parentIndex);
+    writer.member("screenIndex", window.screenIndex);
+    writer.member("screenSize", window.screenSize);
+    writer.member("windowState", window.windowState);
+    writer.endObject();
+}
+
+void writeJson(JsonStreamWriter &writer, const LayoutSaver::Layout &layout)
+{
+    writer.beginObject();
+
+    // Like to_json(), an empty list of dock widgets is written as null
+    writer.key("allDockWidgets");
+    if (layout.allDockWidgets.isEmpty()) {
+        writer.value(nullptr);
+    } else {
+        writer.beginArray();
+        for (const auto &dw : layout.allDockWidgets)
+            writer.value(nlohmann::json(*dw));
+        writer.endArray();
+    }
+
+    writer.member("closedDockWidgets", ::dockWidgetNames(layout.closedDockWidgets));
+
+    writer.key("floatingWindows");
+    writer.beginArray();
+    for (const auto &window : layout.floatingWindows)
+        writeJson(writer, window);
+    writer.endArray();
+
+    writer.key("mainWindows");
+    writer.beginArray();
+    for (const auto &mw : layout.mainWindows)
+        writeJson(writer, mw);
+    writer.endArray();
+
+    writer.member("screenInfo", layout.screenInfo);
+    writer.member("serializationVersion", layout.serializationVersion);
+
+    writer.endObject();
+    writer.flush();
+}
+
+/// Fills a LayoutSaver::Layout from nlohmann's SAX events.
+/// Only one element of the top-level lists, for example a single main window, is held as a DOM
+/// at a time. It's then converted with from_json() and discarded.
+class LayoutSaxReader
+{
+public:
+    using json = nlohmann::json;
+
+    LayoutSaxReader()
+    {
+        // Same defaults as from_json()
+        m_layout.serializationVersion = 0;
+    }
+
+    /// Moves what was parsed into @p layout. Call only if parsing succeeded, so a failed
+    /// parse doesn't leave @p layout half filled.
+    void moveInto(LayoutSaver::Layout &layout)
+    {
+        layout.serializationVersion = m_layout.serializationVersion;
+        layout.mainWindows = std::move(m_layout.mainWindows);
+        layout.floatingWindows = std::move(m_layout.floatingWindows);
+        layout.closedDockWidgets = std::move(m_layout.closedDockWidgets);
+        layout.allDockWidgets = std::move(m_layout.allDockWidgets);
+        layout.screenInfo = std::move(m_layout.screenInfo);
+    }
+
+    bool null()
+    {
+        return addValue(nullptr);
+    }
+
+    bool boolean(bool value)
+    {
+        return addValue(value);
+    }
+
+    bool number_integer(json::number_integer_t value)
+    {
+        return addValue(value);
+    }
+
+    bool number_unsigned(json::number_unsigned_t value)
+    {
+        return addValue(value);
+    }
+
+    bool number_float(json::number_float_t value, const json::string_t &)
+    {
+        return addValue(value);
+    }
+
+    bool string(json::string_t &value)
+    {
+        return addValue(std::move(value));
+    }
+
+    bool binary(json::binary_t &value)
+    {
+        return addValue(json::binary(std::move(value)));
+    }
+
+    bool start_object(std::size_t)
+    {
+        return startContainer(json::object());
+    }
+
+    bool end_object()
+    {
+        return endContainer();
+    }
+
+    bool start_array(std::size_t)
+    {
+        return startContainer(json::array());
+    }
+
+    bool end_array()
+    {
+        return endContainer();
+    }
+
+    bool key(json::string_t &name)
+    {
+        if (m_stack.empty() && m_depth == 1) {
+            m_topLevelKey = std::move(name);
+        } else {
+            m_key = std::move(name);
+        }
+
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string &, const json::exception &)
+    {
+        return false;
+    }
+
+private:
+    bool isTopLevelList() const
+    {
+        return m_topLevelKey == "mainWindows" || m_topLevelKey == "floatingWindows"
+            || m_topLevelKey == "allDockWidgets" || m_topLevelKey == "closedDockWidgets"
+            || m_topLevelKey == "screenInfo";
+    }
+
+    bool startContainer(json &&container)
+    {
+        if (m_depth == 0) {
+            // The document itself isn't held as a DOM
+            ++m_depth;
+            return container.is_object();
+        }
+
+        if (m_stack.empty() && m_depth == 1 && container.is_array() && isTopLevelList()) {
+            // Each element of the list is converted separately
+            m_inTopLevelList = true;
+            ++m_depth;
+            return true;
+        }
+
+        ++m_depth;
+        m_stack.push_back(insert(std::move(container)));
+        return true;
+    }
+
+    bool endContainer()
+    {
+        --m_depth;
+        if (m_stack.empty()) {
+            // End of a top-level list or of the document
+            m_inTopLevelList = false;
+            return true;
+        }
+
+        m_stack.pop_back();
+        return m_stack.empty() ? consumeElement() : true;
+    }
+
+    bool addValue(json &&value)
+    {
+        if (m_depth == 0)
+            return false; // Document isn't an object
+
+        if (m_stack.empty()) {
+            m_element = std::move(value);
+            return consumeElement();
+        }
+
+        insert(std::move(value));
+        return true;
+    }
+
+    json *insert(json &&value)
+    {
+        if (m_stack.empty()) {
+            m_element = std::move(value);
+            return &m_element;
+        }
+
+        json *parent = m_stack.back();
+        if (parent->is_array()) {
+            parent->push_back(std::move(value));
+            return &parent->back();
+        }
+
+        json &member = (*parent)[m_key];
+        member = std::move(value);
+        return &member;
+    }
+
+    /// Called once m_element is complete. Conversion errors throw, like with from_json()
+    bool consumeElement()
+    {
+        const json element = std::move(m_element);
+        m_element = nullptr;
+
+        if (!m_inTopLevelList) {
+            if (isTopLevelList()) {
+                // Like with from_json(), these two can be null, as that's how empty ones are written
+                return element.is_null()
+                    && (m_topLevelKey == "allDockWidgets" || m_topLevelKey == "closedDockWidgets");
+            }
+            if (m_topLevelKey == "serializationVersion")
+                m_layout.serializationVersion = element.get<int>();
+            return true;
+        }
+
+        if (m_topLevelKey == "mainWindows") {
+            m_layout.mainWindows.push_back(element.get<LayoutSaver::MainWindow>());
+        } else if (m_topLevelKey == "floatingWindows") {
+            m_layout.floatingWindows.push_back(element.get<LayoutSaver::FloatingWindow>());
+        } else if (m_topLevelKey == "screenInfo") {
+            m_layout.screenInfo.push_back(element.get<LayoutSaver::ScreenInfo>());
+        } else if (m_topLevelKey == "closedDockWidgets") {
+            m_layout.closedDockWidgets.push_back(
+                LayoutSaver::DockWidget::dockWidgetForName(element.get<QString>()));
+        } else if (m_topLevelKey == "allDockWidgets") {
+            auto it = element.find("uniqueName");
+            if (it == element.end()) {
+                KDDW_ERROR("Unexpected no uniqueName");
+                return true;
+            }
+            auto dw = LayoutSaver::DockWidget::dockWidgetForName(it->get<QString>());
+            from_json(element, *dw);
+            m_layout.allDockWidgets.push_back(dw);
+        }
+
+        return true;
+    }
+
+    LayoutSaver::Layout m_layout;
+    int m_depth = 0;
+    bool m_inTopLevelList = false;
+    std::string m_topLevelKey;
+    std::string m_key;
+    json m_element;
+    std::vector<json *> m_stack;
+};
+
+}
+
+namespace {
+
+/// Adds its lifetime and the objects created meanwhile to a phase of @p profile, if not null
+class RestorePhaseScope
+{
+public:
+    RestorePhaseScope(LayoutSaver::RestoreProfile *profile, LayoutSaver::RestoreProfile::Phase phase)
+        : m_stats(profile ? &profile->stats(phase) : nullptr)
+        , m_start(m_stats ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point())
+        , m_numGroups(Core::Group::Private::s_numCreated)
+        , m_numItems(Core::Item::s_numCreated)
+        , m_numSeparators(Core::LayoutingSeparator::s_numCreated)
+    {
+    }
+
+    ~RestorePhaseScope()
+    {
+        finish();
+    }
+
+    /// Ends the phase before going out of scope
+    void finish()
+    {
+        if (!m_stats)
+            return;
+
+        const auto elapsed = std::chrono::steady_clock::now() - m_start;
+        m_stats->durationUs += std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+        m_stats->numGroupsCreated += Core::Group::Private::s_numCreated - m_numGroups;
+        m_stats->numItemsCreated += Core::Item::s_numCreated - m_numItems;
+        m_stats->numSeparatorsCreated += Core::LayoutingSeparator::s_numCreated - m_numSeparators;
+        m_stats = nullptr;
+    }
+
+private:
+    KDDW_DELETE_COPY_CTOR(RestorePhaseScope)
+    LayoutSaver::RestoreProfile::PhaseStats *m_stats;
+    const std::chrono::steady_clock::time_point m_start;
+    const int m_numGroups;
+    const int m_numItems;
+    const int m_numSeparators;
+};
+
+}
+
 LayoutSaver::LayoutSaver(RestoreOptions options)
     : d(new Private(options))
 {
@@ -385,7 +911,8 @@ LayoutSaver::~LayoutSaver()
 
 bool LayoutSaver::saveToFile(const QString &jsonFilename)
 {
-    const QByteArray data = serializeLayout();
+    LayoutSaver::Layout layout;
+    const bool serialized = d->serializeLayout(layout);
 
     std::ofstream file(jsonFilename.toStdString(), std::ios::binary);
     if (!file.is_open()) {
@@ -393,7 +920,22 @@ bool LayoutSaver::saveToFile(const QString &jsonFilename)
         return false;
     }
 
-    file.write(data.constData(), data.size());
+    if (serialized) {
+        bool written = false;
+        if (d->m_format == LayoutSaverFormat::Cbor) {
+            const QByteArray data = layout.toCbor();
+            written = bool(file.write(data.constData(), data.size()));
+        } else {
+            // JSON is streamed straight into the file, we don't hold a copy of it
+            written = layout.toJson(file);
+        }
+
+        if (!written) {
+            KDDW_ERROR("Failed to write {}", jsonFilename);
+            return false;
+        }
+    }
+
     file.close();
     return true;
 }
@@ -411,61 +953,158 @@ bool LayoutSaver::restoreFromFile(const QString &jsonFilename)
 
 QByteArray LayoutSaver::serializeLayout() const
 {
-    if (!d->m_dockRegistry->isSane()) {
-        KDDW_ERROR("Refusing to serialize this layout. Check previous warnings.");
+    LayoutSaver::Layout layout;
+    if (!d->serializeLayout(layout))
         return {};
+
+    return d->m_format == LayoutSaverFormat::Cbor ? layout.toCbor() : layout.toJson();
+}
+
+bool LayoutSaver::Private::serializeLayout(LayoutSaver::Layout &layout) const
+{
+    if (!m_dockRegistry->isSane()) {
+        KDDW_ERROR("Refusing to serialize this layout. Check previous warnings.");
+        return false;
     }
 
-    LayoutSaver::Layout layout;
+    layout.saveScreenInfo();
 
     // Just a simplification. One less type of windows to handle.
-    d->m_dockRegistry->ensureAllFloatingWidgetsAreMorphed();
+    m_dockRegistry->ensureAllFloatingWidgetsAreMorphed();
 
-    const auto mainWindows = d->m_dockRegistry->mainwindows();
+    const auto mainWindows = m_dockRegistry->mainwindows();
     layout.mainWindows.reserve(mainWindows.size());
     for (auto mainWindow : mainWindows) {
-        if (d->matchesAffinity(mainWindow->affinities()))
+        if (matchesAffinity(mainWindow->affinities()))
             layout.mainWindows.push_back(mainWindow->serialize());
     }
 
     const Vector<Core::FloatingWindow *> floatingWindows =
-        d->m_dockRegistry->floatingWindows(/*includeBeingDeleted=*/false, /*honourSkipped=*/true);
+        m_dockRegistry->floatingWindows(/*includeBeingDeleted=*/false, /*honourSkipped=*/true);
     layout.floatingWindows.reserve(floatingWindows.size());
     for (Core::FloatingWindow *floatingWindow : floatingWindows) {
-        if (d->matchesAffinity(floatingWindow->affinities()))
+        if (matchesAffinity(floatingWindow->affinities()))
             layout.floatingWindows.push_back(floatingWindow->serialize());
     }
 
     // Closed dock widgets also have interesting things to save, like geometry and placeholder info
-    const Core::DockWidget::List closedDockWidgets = d->m_dockRegistry->closedDockwidgets(/*honourSkipped=*/true);
+    const Core::DockWidget::List closedDockWidgets = m_dockRegistry->closedDockwidgets(/*honourSkipped=*/true);
     layout.closedDockWidgets.reserve(closedDockWidgets.size());
     for (Core::DockWidget *dockWidget : closedDockWidgets) {
-        if (d->matchesAffinity(dockWidget->affinities()))
+        if (matchesAffinity(dockWidget->affinities()))
             layout.closedDockWidgets.push_back(dockWidget->d->serialize());
     }
 
     // Save the placeholder info. We do it last, as we also restore it last, since we need all items
     // to be created before restoring the placeholders
 
-    const Core::DockWidget::List dockWidgets = d->m_dockRegistry->dockwidgets();
+    const Core::DockWidget::List dockWidgets = m_dockRegistry->dockwidgets();
     layout.allDockWidgets.reserve(dockWidgets.size());
     for (Core::DockWidget *dockWidget : dockWidgets) {
-        if (!dockWidget->skipsRestore() && d->matchesAffinity(dockWidget->affinities())) {
+        if (!dockWidget->skipsRestore() && matchesAffinity(dockWidget->affinities())) {
             auto dw = dockWidget->d->serialize();
             dw->lastPosition = dockWidget->d->lastPosition()->serialize();
             layout.allDockWidgets.push_back(dw);
         }
     }
 
-    return layout.toJson();
+    return true;
+}
+
+void LayoutSaver::setFormat(LayoutSaverFormat format)
+{
+    d->m_format = format;
+}
+
+LayoutSaverFormat LayoutSaver::format() const
+{
+    return d->m_format;
+}
+
+std::shared_ptr<LayoutSaver::Layout> LayoutSaver::prepareLayout(const QByteArray &data)
+{
+    return Private::prepareLayout(data, nullptr);
+}
+
+std::shared_ptr<LayoutSaver::Layout> LayoutSaver::Private::prepareLayout(const QByteArray &data,
+                                                                         RestoreProfile *profile)
+{
+    using Phase = RestoreProfile::Phase;
+    auto layout = std::make_shared<LayoutSaver::Layout>();
+
+    {
+        RestorePhaseScope phase(profile, Phase::Parse);
+
+        // Reject corrupted data before anything is allocated for it
+        std::string error;
+        if (!LayoutSaver::Layout::isWellFormed(data, &error)) {
+            KDDW_WARN("Refusing to restore malformed layout: {}", error);
+            return {};
+        }
+
+        // Dock widgets are shared between the groups and allDockWidgets. Don't use the global
+        // s_dockWidgets for that, as the GUI thread might be using it.
+        std::map<QString, LayoutSaver::DockWidget::Ptr> dockWidgets;
+        auto previousDockWidgets = std::exchange(t_dockWidgetsBeingPrepared, &dockWidgets);
+
+        const bool ok = layout->fromSerialized(data);
+        t_dockWidgetsBeingPrepared = previousDockWidgets;
+
+        if (!ok) {
+            KDDW_ERROR("Failed to parse layout data");
+            return {};
+        }
+    }
+
+    RestorePhaseScope phase(profile, Phase::Validate);
+    if (!layout->isValid())
+        return {};
+
+    return layout;
 }
 
 bool LayoutSaver::restoreLayout(const QByteArray &data)
 {
+    if (data.isEmpty()) {
+        LayoutSaver::DockWidget::s_dockWidgets.clear();
+        d->clearRestoredProperty();
+        return true;
+    }
+
+    if (!d->m_restoreProfilingEnabled)
+        return restoreLayout(prepareLayout(data));
+
+    RestoreProfile profile;
+    auto layout = Private::prepareLayout(data, &profile);
+    const bool ok = restoreLayout(layout);
+
+    // Add the parse phases to what restoreLayout() recorded
+    for (auto phase : { RestoreProfile::Phase::Parse, RestoreProfile::Phase::Validate })
+        d->m_lastRestoreProfile.stats(phase) = profile.stats(phase);
+
+    return ok;
+}
+
+bool LayoutSaver::restoreLayout(const std::shared_ptr<LayoutSaver::Layout> &layout)
+{
+    using Phase = RestoreProfile::Phase;
+    RestoreProfile *profile = nullptr;
+    if (d->m_restoreProfilingEnabled) {
+        d->m_lastRestoreProfile = {};
+        d->m_lastRestoreProfile.isValid = true;
+        profile = &d->m_lastRestoreProfile;
+    }
+
     LayoutSaver::DockWidget::s_dockWidgets.clear();
     d->clearRestoredProperty();
-    if (data.isEmpty())
-        return true;
+    if (!layout)
+        return false;
+
+    if (layout->wasRestored) {
+        KDDW_ERROR("A prepared layout can only be restored once");
+        return false;
+    }
+    layout->wasRestored = true;
 
     struct GroupCleanup
     {
@@ -485,33 +1124,52 @@ bool LayoutSaver::restoreLayout(const QByteArray &data)
         LayoutSaver *const m_saver;
     };
 
+    // Position::deserialize() needs to know about the floating windows being restored
+    struct CurrentLayout
+    {
+        explicit CurrentLayout(LayoutSaver::Layout *layout)
+        {
+            LayoutSaver::Layout::s_currentLayoutBeingRestored = layout;
+        }
+
+        ~CurrentLayout()
+        {
+            LayoutSaver::Layout::s_currentLayoutBeingRestored = nullptr;
+        }
+
+        KDDW_DELETE_COPY_CTOR(CurrentLayout)
+    };
+
     GroupCleanup cleanup(this);
-    LayoutSaver::Layout layout;
-    if (!layout.fromJson(data)) {
-        KDDW_ERROR("Failed to parse json data");
-        return false;
-    }
+    CurrentLayout currentLayout(layout.get());
 
-    if (!layout.isValid()) {
-        return false;
+    {
+        // Needs the current main window geometry, so isn't done by prepareLayout()
+        RestorePhaseScope phase(profile, Phase::ScaleSizes);
+        layout->scaleSizes(d->m_restoreOptions);
     }
 
-    layout.scaleSizes(d->m_restoreOptions);
-
-    d->floatWidgetsWhichSkipRestore(layout.mainWindowNames());
-    d->floatUnknownWidgets(layout);
+    {
+        // Before RAIIIsRestoring, so the floated dock widgets are laid out normally
+        RestorePhaseScope phase(profile, Phase::FloatUnknownDockWidgets);
+        d->floatWidgetsWhichSkipRestore(layout->mainWindowNames());
+        d->floatUnknownWidgets(*layout);
+    }
 
     Private::RAIIIsRestoring isRestoring;
 
-    // Hide all dockwidgets and unparent them from any layout before starting restore
-    // We only close the stuff that the loaded JSON knows about. Unknown widgets might be newer.
-
-    d->m_dockRegistry->clear(d->m_dockRegistry->dockWidgets(layout.dockWidgetsToClose()),
-                             d->m_dockRegistry->mainWindows(layout.mainWindowNames()),
-                             d->m_affinityNames);
+    {
+        RestorePhaseScope phase(profile, Phase::ClearRegistry);
+        // Hide all dockwidgets and unparent them from any layout before starting restore
+        // We only close the stuff that the loaded JSON knows about. Unknown widgets might be newer.
+        d->m_dockRegistry->clear(d->m_dockRegistry->dockWidgets(layout->dockWidgetsToClose()),
+                                 d->m_dockRegistry->mainWindows(layout->mainWindowNames()),
+                                 d->m_affinityNames);
+    }
 
     // 1. Restore main windows
-    for (const LayoutSaver::MainWindow &mw : std::as_const(layout.mainWindows)) {
+    RestorePhaseScope mainWindowsPhase(profile, Phase::MainWindows);
+    for (const LayoutSaver::MainWindow &mw : std::as_const(layout->mainWindows)) {
         auto mainWindow = d->m_dockRegistry->mainWindowByName(mw.uniqueName);
         if (!mainWindow) {
             if (auto mwFunc = Config::self().mainWindowFactoryFunc()) {
@@ -541,8 +1199,11 @@ bool LayoutSaver::restoreLayout(const QByteArray &data)
             return false;
     }
 
+    mainWindowsPhase.finish();
+
     // 2. Restore FloatingWindows
-    for (LayoutSaver::FloatingWindow &fw : layout.floatingWindows) {
+    RestorePhaseScope floatingWindowsPhase(profile, Phase::FloatingWindows);
+    for (LayoutSaver::FloatingWindow &fw : layout->floatingWindows) {
         if (!d->matchesAffinity(fw.affinities) || fw.skipsRestore())
             continue;
 
@@ -562,11 +1223,16 @@ bool LayoutSaver::restoreLayout(const QByteArray &data)
         }
     }
 
+    floatingWindowsPhase.finish();
+
     // 3. Restore closed dock widgets. They remain closed but acquire geometry and placeholder
     // properties
-    for (const auto &dw : std::as_const(layout.closedDockWidgets)) {
-        if (d->matchesAffinity(dw->affinities)) {
-            Core::DockWidget::deserialize(dw);
+    {
+        RestorePhaseScope phase(profile, Phase::ClosedDockWidgets);
+        for (const auto &dw : std::as_const(layout->closedDockWidgets)) {
+            if (d->matchesAffinity(dw->affinities)) {
+                Core::DockWidget::deserialize(dw);
+            }
         }
     }
 
@@ -574,7 +1240,8 @@ bool LayoutSaver::restoreLayout(const QByteArray &data)
     LayoutSaver::Private::s_unrestoredProperties.clear();
 
     // 4. Restore the placeholder info, now that the Items have been created
-    for (const auto &dw : std::as_const(layout.allDockWidgets)) {
+    RestorePhaseScope placeholdersPhase(profile, Phase::Placeholders);
+    for (const auto &dw : std::as_const(layout->allDockWidgets)) {
         if (!d->matchesAffinity(dw->affinities))
             continue;
 
@@ -620,6 +1287,89 @@ Core::DockWidget::List LayoutSaver::restoredDockWidgets() const
     return result;
 }
 
+void LayoutSaver::setRestoreProfilingEnabled(bool enabled)
+{
+    d->m_restoreProfilingEnabled = enabled;
+}
+
+bool LayoutSaver::restoreProfilingEnabled() const
+{
+    return d->m_restoreProfilingEnabled;
+}
+
+LayoutSaver::RestoreProfile LayoutSaver::lastRestoreProfile() const
+{
+    return d->m_lastRestoreProfile;
+}
+
+const LayoutSaver::RestoreProfile::PhaseStats &LayoutSaver::RestoreProfile::stats(Phase phase) const
+{
+    return m_stats[int(phase)];
+}
+
+LayoutSaver::RestoreProfile::PhaseStats &LayoutSaver::RestoreProfile::stats(Phase phase)
+{
+    return m_stats[int(phase)];
+}
+
+int64_t LayoutSaver::RestoreProfile::totalDurationUs() const
+{
+    int64_t total = 0;
+    for (const PhaseStats &phaseStats : m_stats)
+        total += phaseStats.durationUs;
+
+    return total;
+}
+
+const char *LayoutSaver::RestoreProfile::phaseName(Phase phase)
+{
+    switch (phase) {
+    case Phase::Parse:
+        return "Parse";
+    case Phase::Validate:
+        return "Validate";
+    case Phase::ScaleSizes:
+        return "ScaleSizes";
+    case Phase::FloatUnknownDockWidgets:
+        return "FloatUnknownDockWidgets";
+    case Phase::ClearRegistry:
+        return "ClearRegistry";
+    case Phase::MainWindows:
+        return "MainWindows";
+    case Phase::FloatingWindows:
+        return "FloatingWindows";
+    case Phase::ClosedDockWidgets:
+        return "ClosedDockWidgets";
+    case Phase::Placeholders:
+        return "Placeholders";
+    case Phase::Count:
+        break;
+    }
+
+    return "";
+}
+
+QByteArray LayoutSaver::RestoreProfile::toJson() const
+{
+    nlohmann::json json;
+    json["totalDurationUs"] = totalDurationUs();
+
+    auto &phases = json["phases"];
+    phases = nlohmann::json::array();
+    for (int i = 0; i < int(Phase::Count); ++i) {
+        const PhaseStats &phaseStats = m_stats[i];
+        nlohmann::json phase;
+        phase["name"] = phaseName(Phase(i));
+        phase["durationUs"] = phaseStats.durationUs;
+        phase["groupsCreated"] = phaseStats.numGroupsCreated;
+        phase["itemsCreated"] = phaseStats.numItemsCreated;
+        phase["separatorsCreated"] = phaseStats.numSeparatorsCreated;
+        phases.push_back(phase);
+    }
+
+    return QByteArray::fromStdString(json.dump(4));
+}
+
 void LayoutSaver::Private::clearRestoredProperty()
 {
     const Core::DockWidget::List &allDockWidgets = DockRegistry::self()->dockwidgets();
@@ -780,7 +1530,7 @@ Vector<QString> LayoutSaver::openedDockWidgetsInLayout(const QString &jsonFilena
 Vector<QString> LayoutSaver::openedDockWidgetsInLayout(const QByteArray &serialized)
 {
     LayoutSaver::Layout layout;
-    if (!layout.fromJson(serialized))
+    if (!layout.fromSerialized(serialized))
         return {};
 
     Vector<QString> names;
@@ -813,7 +1563,7 @@ Vector<QString> LayoutSaver::sideBarDockWidgetsInLayout(const QString &jsonFilen
 Vector<QString> LayoutSaver::sideBarDockWidgetsInLayout(const QByteArray &serialized)
 {
     LayoutSaver::Layout layout;
-    if (!layout.fromJson(serialized))
+    if (!layout.fromSerialized(serialized))
         return {};
 
     Vector<QString> names;
@@ -861,30 +1611,483 @@ void from_json(const nlohmann::json &j, LayoutSaver::Layout &layout)
 
 QByteArray LayoutSaver::Layout::toJson() const
 {
-    nlohmann::json json = *this;
-    return QByteArray::fromStdString(json.dump(4));
+    QByteArray result;
+    JsonStreamWriter writer([&result](const char *data, std::size_t size) {
+        result.append(data, int(size));
+    });
+    writeJson(writer, *this);
+    return result;
+}
+
+bool LayoutSaver::Layout::toJson(std::ostream &stream) const
+{
+    JsonStreamWriter writer([&stream](const char *data, std::size_t size) {
+        stream.write(data, std::streamsize(size));
+    });
+    writeJson(writer, *this);
+    return stream.good();
 }
 
 bool LayoutSaver::Layout::fromJson(const QByteArray &jsonData)
 {
-    nlohmann::json json = nlohmann::json::parse(jsonData, nullptr, /*allow_exceptions=*/false);
-    if (json.is_discarded()) {
+    try {
+        LayoutSaxReader reader;
+        const char *begin = jsonData.constData();
+        if (!nlohmann::json::sax_parse(begin, begin + jsonData.size(), &reader))
+            return false;
+
+        reader.moveInto(*this);
+        return true;
+    } catch (const std::exception &e) {
+        KDDW_ERROR("LayoutSaver::Layout::fromJson: Caught exception: {}", e.what());
+        return false;
+    } catch (...) {
+        KDDW_ERROR("LayoutSaver::Layout::fromJson: Caught exception.");
         return false;
     }
+}
+
+// CBOR's "self-described CBOR" tag (RFC 8949, 3.4.6). We prefix our CBOR with it, so it
+// can be told apart from JSON, which never starts with these bytes.
+static const unsigned char s_cborMagic[] = { 0xD9, 0xD9, 0xF7 };
+
+static bool isCbor(const QByteArray &data)
+{
+    return data.size() >= int(sizeof(s_cborMagic))
+        && std::memcmp(data.constData(), s_cborMagic, sizeof(s_cborMagic)) == 0;
+}
+
+static QByteArray toCbor(const nlohmann::json &json)
+{
+    std::string cbor(reinterpret_cast<const char *>(s_cborMagic), sizeof(s_cborMagic));
+    nlohmann::json::to_cbor(json, cbor);
+    return QByteArray::fromStdString(cbor);
+}
+
+static QByteArray toSerialized(const nlohmann::json &json, LayoutSaverFormat format)
+{
+    return format == LayoutSaverFormat::Cbor ? toCbor(json) : QByteArray::fromStdString(json.dump(4));
+}
+
+/// Parses either JSON or CBOR. Returns a discarded value on failure.
+static nlohmann::json parseSerialized(const QByteArray &data)
+{
+    if (!isCbor(data))
+        return nlohmann::json::parse(data, nullptr, /*allow_exceptions=*/false);
+
+    const char *begin = data.constData() + sizeof(s_cborMagic);
+    const char *end = data.constData() + data.size();
+    return nlohmann::json::from_cbor(begin, end, /*strict=*/true, /*allow_exceptions=*/false);
+}
+
+QByteArray LayoutSaver::Layout::toCbor() const
+{
+    return ::toCbor(*this);
+}
+
+bool LayoutSaver::Layout::fromCbor(const QByteArray &cborData)
+{
+    if (!isCbor(cborData))
+        return false;
+
+    const char *begin = cborData.constData() + sizeof(s_cborMagic);
+    const char *end = cborData.constData() + cborData.size();
 
     try {
-        from_json(json, *this);
+        LayoutSaxReader reader;
+        if (!nlohmann::json::sax_parse(begin, end, &reader, nlohmann::json::input_format_t::cbor))
+            return false;
+
+        reader.moveInto(*this);
+        return true;
     } catch (const std::exception &e) {
-        KDDW_ERROR("LayoutSaver::Layout::fromJson: Caught exception: {}", e.what());
+        KDDW_ERROR("LayoutSaver::Layout::fromCbor: Caught exception: {}", e.what());
         return false;
     } catch (...) {
-        KDDW_ERROR("LayoutSaver::Layout::fromJson: Caught exception.");
+        KDDW_ERROR("LayoutSaver::Layout::fromCbor: Caught exception.");
         return false;
     }
+}
+
+bool LayoutSaver::Layout::fromSerialized(const QByteArray &data)
+{
+    return isCbor(data) ? fromCbor(data) : fromJson(data);
+}
+
+bool LayoutSaver::Layout::isWellFormed(const QByteArray &data, std::string *error)
+{
+    const char *begin = data.constData();
+    const char *end = data.constData() + data.size();
+    if (!isCbor(data))
+        return LayoutSchemaValidator::validate(begin, end, nlohmann::json::input_format_t::json, error);
+
+    return LayoutSchemaValidator::validate(begin + sizeof(s_cborMagic), end,
+                                           nlohmann::json::input_format_t::cbor, error);
+}
+
+struct LayoutSaver::Private::DeltaState
+{
+    /// What a window is serialized from, minus the layout, which is represented by its generation.
+    /// All of it is cheap to query, so it's compared instead of serializing the window.
+    /// Window geometry is owned by the windowing system, there's no change notification for it.
+    struct WindowKey
+    {
+        uint64_t layoutGeneration = 0;
+        Rect geometry;
+        Rect normalGeometry;
+        bool isVisible = false;
+        WindowState windowState = WindowState::None;
+        int screenIndex = -1;
+        Size screenSize;
+        Vector<QString> affinities;
+        int parentIndex = -1;
+        Vector<Vector<Core::DockWidget *>> sideBars;
+
+        bool operator==(const WindowKey &other) const
+        {
+            return layoutGeneration == other.layoutGeneration && geometry == other.geometry
+                && normalGeometry == other.normalGeometry && isVisible == other.isVisible
+                && windowState == other.windowState && screenIndex == other.screenIndex
+                && screenSize == other.screenSize && affinities == other.affinities
+                && parentIndex == other.parentIndex && sideBars == other.sideBars;
+        }
+
+        bool operator!=(const WindowKey &other) const
+        {
+            return !(*this == other);
+        }
+    };
+
+    /// A window is only serialized again if its key changed.
+    /// Its layout only if the layout's generation changed.
+    struct Window
+    {
+        WindowKey key;
+        nlohmann::json layout;
+        nlohmann::json properties;
+
+        nlohmann::json toJson() const
+        {
+            nlohmann::json json = properties;
+            json["multiSplitterLayout"] = layout;
+            return json;
+        }
+
+        /// Serializes @p window again if its key changed. Returns whether anything changed.
+        template<typename T>
+        bool update(const T *window, WindowKey &&newKey)
+        {
+            if (newKey == key)
+                return false;
+
+            const bool layoutChanged = newKey.layoutGeneration != key.layoutGeneration;
+            const auto saved = window->serialize(/*includeLayout=*/layoutChanged);
+            if (layoutChanged)
+                layout = saved.multiSplitterLayout;
+
+            nlohmann::json newProperties = saved;
+            newProperties.erase("multiSplitterLayout");
+
+            const bool changed = layoutChanged || newProperties != properties;
+            properties = std::move(newProperties);
+            key = std::move(newKey);
+
+            return changed;
+        }
+    };
+
+    /// A dock widget is only serialized again if its position changed, or if its placeholders'
+    /// indexes might have, which only happens when items are added or removed from their layouts.
+    struct Dock
+    {
+        uint64_t positionGeneration = 0;
+        std::vector<std::pair<const Core::Item *, uint64_t>> placeholderKeys;
+        Vector<QString> affinities;
+        CloseReason lastCloseReason = CloseReason::Unspecified;
+        nlohmann::json json;
+
+        /// Returns whether @p dockWidget needs to be serialized again. Updates the keys.
+        bool update(Core::DockWidget *dockWidget, bool floatingWindowIndexesChanged)
+        {
+            const KDDockWidgets::Position::Ptr position = dockWidget->d->lastPosition();
+            bool changed = floatingWindowIndexesChanged || json.is_null();
+
+            if (position->generation() != positionGeneration) {
+                positionGeneration = position->generation();
+                changed = true;
+            }
+
+            const auto &placeholders = position->placeholders();
+            if (placeholders.size() != placeholderKeys.size()) {
+                placeholderKeys.resize(placeholders.size());
+                changed = true;
+            }
+
+            for (size_t i = 0; i < placeholders.size(); ++i) {
+                const Core::Item *item = placeholders[i]->item;
+                LayoutingHost *host = item ? item->host() : nullptr;
+                const std::pair<const Core::Item *, uint64_t> placeholderKey = { item, host ? host->structureGeneration() : 0 };
+                if (placeholderKey != placeholderKeys[i]) {
+                    placeholderKeys[i] = placeholderKey;
+                    changed = true;
+                }
+            }
+
+            if (dockWidget->d->m_lastCloseReason != lastCloseReason) {
+                lastCloseReason = dockWidget->d->m_lastCloseReason;
+                changed = true;
+            }
+
+            if (dockWidget->affinities() != affinities) {
+                affinities = dockWidget->affinities();
+                changed = true;
+            }
+
+            return changed;
+        }
+    };
+
+    static WindowKey windowKey(Core::MainWindow *);
+    static WindowKey windowKey(Core::FloatingWindow *);
+    static WindowKey windowKey(Core::View *, Core::Layout *);
+
+    std::unordered_map<QString, Window> mainWindows;
+    std::unordered_map<const Core::FloatingWindow *, Window> floatingWindows;
+    std::unordered_map<QString, Dock> dockWidgets;
+
+    /// The floating windows we serialized last time, in order
+    Vector<Core::FloatingWindow *> serializedFloatingWindows;
+
+    /// Placeholders in floating windows are saved with the floating window's index in this list
+    Vector<Core::FloatingWindow *> placeholderFloatingWindows;
+};
+
+LayoutSaver::Private::~Private() = default;
+
+LayoutSaver::Private::DeltaState::WindowKey LayoutSaver::Private::DeltaState::windowKey(Core::View *view, Core::Layout *layout)
+{
+    WindowKey key;
+    key.layoutGeneration = layout->asLayoutingHost()->generation();
+    key.normalGeometry = view->normalGeometry();
+    key.screenIndex = Platform::instance()->screenNumberForView(view);
+    key.screenSize = Platform::instance()->screenSizeFor(view);
+
+    return key;
+}
+
+LayoutSaver::Private::DeltaState::WindowKey LayoutSaver::Private::DeltaState::windowKey(Core::MainWindow *mainWindow)
+{
+    auto key = windowKey(mainWindow->view(), mainWindow->layout());
+    key.geometry = mainWindow->d->windowGeometry();
+    key.isVisible = mainWindow->isVisible();
+    key.affinities = mainWindow->affinities();
+
+    Core::Window::Ptr window = mainWindow->view()->window();
+    key.windowState = window ? window->windowState() : WindowState::None;
+
+    for (SideBarLocation loc : { SideBarLocation::North, SideBarLocation::East,
+                                 SideBarLocation::West, SideBarLocation::South }) {
+        Core::SideBar *sb = mainWindow->sideBar(loc);
+        key.sideBars.push_back(sb ? sb->dockWidgets() : Vector<Core::DockWidget *>());
+    }
+
+    return key;
+}
+
+LayoutSaver::Private::DeltaState::WindowKey LayoutSaver::Private::DeltaState::windowKey(Core::FloatingWindow *floatingWindow)
+{
+    auto key = windowKey(floatingWindow->view(), floatingWindow->layout());
+    key.geometry = floatingWindow->geometry();
+    key.isVisible = floatingWindow->isVisible();
+    key.affinities = floatingWindow->affinities();
+    // Same as FloatingWindow::windowStateOverride()
+    if (floatingWindow->view()->isMaximized())
+        key.windowState = WindowState::Maximized;
+    else if (floatingWindow->view()->isMinimized())
+        key.windowState = WindowState::Minimized;
+
+    Core::Window::Ptr transientParentWindow = floatingWindow->view()->d->transientWindow();
+    auto transientMainWindow = DockRegistry::self()->mainWindowForHandle(transientParentWindow);
+    key.parentIndex =
+        transientMainWindow ? DockRegistry::self()->mainwindows().indexOf(transientMainWindow) : -1;
+
+    return key;
+}
+
+QByteArray LayoutSaver::serializeLayoutDelta()
+{
+    if (!d->m_deltaState)
+        d->m_deltaState = std::make_unique<Private::DeltaState>();
+    Private::DeltaState &state = *d->m_deltaState;
+
+    // Unlike serializeLayout() we don't call DockRegistry::isSane(), as it visits everything.
+    // Nor serialize what didn't change, we only check cheap keys and generations for that.
+
+    LayoutSaver::Layout layout;
+    layout.saveScreenInfo();
+    d->m_dockRegistry->ensureAllFloatingWidgetsAreMorphed();
+
+    nlohmann::json json;
+    json["serializationVersion"] = layout.serializationVersion;
+    json["isDelta"] = true;
+    json["screenInfo"] = layout.screenInfo;
+
+    // Main windows. We always save their order but only include the ones which changed.
+    Vector<QString> mainWindowNames;
+    nlohmann::json changedMainWindows = nlohmann::json::object();
+    std::unordered_map<QString, Private::DeltaState::Window> mainWindowStates;
+    for (auto mainWindow : d->m_dockRegistry->mainwindows()) {
+        if (!d->matchesAffinity(mainWindow->affinities()))
+            continue;
+
+        const QString name = mainWindow->uniqueName();
+        Private::DeltaState::Window windowState = std::move(state.mainWindows[name]);
+        if (windowState.update(mainWindow, Private::DeltaState::windowKey(mainWindow)))
+            changedMainWindows[name.toStdString()] = windowState.toJson();
+
+        mainWindowNames.push_back(name);
+        mainWindowStates.emplace(name, std::move(windowState));
+    }
+    state.mainWindows = std::move(mainWindowStates);
+    json["mainWindowNames"] = mainWindowNames;
+    json["mainWindows"] = std::move(changedMainWindows);
+
+    // Floating windows are referenced by index, so we either save all of them or none
+    const Vector<Core::FloatingWindow *> floatingWindows =
+        d->m_dockRegistry->floatingWindows(/*includeBeingDeleted=*/false, /*honourSkipped=*/true);
+    Vector<Core::FloatingWindow *> serializedFloatingWindows;
+    std::unordered_map<const Core::FloatingWindow *, Private::DeltaState::Window> floatingWindowStates;
+    bool floatingWindowsChanged = false;
+    for (Core::FloatingWindow *floatingWindow : floatingWindows) {
+        if (!d->matchesAffinity(floatingWindow->affinities()))
+            continue;
+
+        Private::DeltaState::Window windowState = std::move(state.floatingWindows[floatingWindow]);
+        if (windowState.update(floatingWindow, Private::DeltaState::windowKey(floatingWindow)))
+            floatingWindowsChanged = true;
+
+        serializedFloatingWindows.push_back(floatingWindow);
+        floatingWindowStates.emplace(floatingWindow, std::move(windowState));
+    }
+
+    if (floatingWindowsChanged || serializedFloatingWindows != state.serializedFloatingWindows) {
+        nlohmann::json floatingWindowsJson = nlohmann::json::array();
+        for (Core::FloatingWindow *floatingWindow : std::as_const(serializedFloatingWindows))
+            floatingWindowsJson.push_back(floatingWindowStates[floatingWindow].toJson());
+        json["floatingWindows"] = std::move(floatingWindowsJson);
+    }
+    state.floatingWindows = std::move(floatingWindowStates);
+    state.serializedFloatingWindows = std::move(serializedFloatingWindows);
+
+    Vector<QString> closedDockWidgetNames;
+    for (Core::DockWidget *dockWidget : d->m_dockRegistry->closedDockwidgets(/*honourSkipped=*/true)) {
+        if (d->matchesAffinity(dockWidget->affinities()))
+            closedDockWidgetNames.push_back(dockWidget->uniqueName());
+    }
+    json["closedDockWidgets"] = closedDockWidgetNames;
+
+    // Dock widgets. Like for main windows, only the ones which changed are included.
+    const Vector<Core::FloatingWindow *> placeholderFloatingWindows = d->m_dockRegistry->floatingWindows();
+    const bool floatingWindowIndexesChanged = placeholderFloatingWindows != state.placeholderFloatingWindows;
+    state.placeholderFloatingWindows = placeholderFloatingWindows;
+
+    Vector<QString> dockWidgetNames;
+    nlohmann::json changedDockWidgets = nlohmann::json::object();
+    std::unordered_map<QString, Private::DeltaState::Dock> dockStates;
+    for (Core::DockWidget *dockWidget : d->m_dockRegistry->dockwidgets()) {
+        if (dockWidget->skipsRestore() || !d->matchesAffinity(dockWidget->affinities()))
+            continue;
+
+        const QString name = dockWidget->uniqueName();
+        Private::DeltaState::Dock dockState = std::move(state.dockWidgets[name]);
+        if (dockState.update(dockWidget, floatingWindowIndexesChanged)) {
+            auto dw = dockWidget->d->serialize();
+            dw->lastPosition = dockWidget->d->lastPosition()->serialize();
+
+            nlohmann::json dockJson = *dw;
+            if (dockJson != dockState.json) {
+                changedDockWidgets[name.toStdString()] = dockJson;
+                dockState.json = std::move(dockJson);
+            }
+        }
+
+        dockWidgetNames.push_back(name);
+        dockStates.emplace(name, std::move(dockState));
+    }
+    state.dockWidgets = std::move(dockStates);
+    json["allDockWidgetNames"] = dockWidgetNames;
+    json["allDockWidgets"] = std::move(changedDockWidgets);
+
+    return toSerialized(json, d->m_format);
+}
 
+/// The base layout has an array of main windows (or dock widgets) while the delta only has
+/// the ones which changed, keyed by name, plus the list of names, for the order.
+static bool mergeDeltaEntries(nlohmann::json &layout, const nlohmann::json &delta,
+                              const char *key, const char *namesKey)
+{
+    std::unordered_map<QString, nlohmann::json> entries;
+
+    auto it = layout.find(key);
+    if (it != layout.end() && it->is_array()) {
+        for (auto &entry : *it)
+            entries[jsonValue(entry, "uniqueName", QString())] = std::move(entry);
+    }
+
+    auto changed = delta.find(key);
+    if (changed != delta.end() && changed->is_object()) {
+        for (const auto &kv : changed->items())
+            entries[QString::fromStdString(kv.key())] = kv.value();
+    }
+
+    nlohmann::json merged = nlohmann::json::array();
+    const auto names = jsonValue(delta, namesKey, Vector<QString>());
+    for (const QString &name : names) {
+        auto entry = entries.find(name);
+        if (entry == entries.end()) {
+            KDDW_ERROR("LayoutSaver::applyLayoutDelta: Delta doesn't apply to base, missing {}", name);
+            return false;
+        }
+        merged.push_back(std::move(entry->second));
+    }
+
+    layout[key] = std::move(merged);
     return true;
 }
 
+QByteArray LayoutSaver::applyLayoutDelta(const QByteArray &base, const QByteArray &delta)
+{
+    const nlohmann::json deltaJson = parseSerialized(delta);
+    if (!deltaJson.is_object() || !jsonValue(deltaJson, "isDelta", false)) {
+        KDDW_ERROR("LayoutSaver::applyLayoutDelta: Invalid delta");
+        return {};
+    }
+
+    nlohmann::json layout = base.isEmpty() ? nlohmann::json::object() : parseSerialized(base);
+    if (!layout.is_object()) {
+        KDDW_ERROR("LayoutSaver::applyLayoutDelta: Invalid base layout");
+        return {};
+    }
+
+    try {
+        if (!mergeDeltaEntries(layout, deltaJson, "mainWindows", "mainWindowNames")
+            || !mergeDeltaEntries(layout, deltaJson, "allDockWidgets", "allDockWidgetNames"))
+            return {};
+    } catch (const std::exception &e) {
+        KDDW_ERROR("LayoutSaver::applyLayoutDelta: Caught exception: {}", e.what());
+        return {};
+    }
+
+    // floatingWindows is only present if it changed
+    for (const char *key : { "serializationVersion", "floatingWindows", "closedDockWidgets", "screenInfo" }) {
+        auto it = deltaJson.find(key);
+        if (it != deltaJson.end())
+            layout[key] = *it;
+    }
+
+    return toSerialized(layout, isCbor(delta) ? LayoutSaverFormat::Cbor : LayoutSaverFormat::Json);
+}
+
 void LayoutSaver::Layout::scaleSizes(InternalRestoreOptions options)
 {
     if (mainWindows.isEmpty())
@@ -944,6 +2147,22 @@ LayoutSaver::FloatingWindow LayoutSaver::Layout::floatingWindowForIndex(int inde
     return floatingWindows.at(index);
 }
 
+void LayoutSaver::Layout::saveScreenInfo()
+{
+    const auto screens = Core::Platform::instance()->screens();
+    const int numScreens = screens.size();
+    screenInfo.clear();
+    screenInfo.reserve(numScreens);
+    for (int i = 0; i < numScreens; ++i) {
+        ScreenInfo info;
+        info.index = i;
+        info.geometry = screens[i]->geometry();
+        info.name = screens[i]->name();
+        info.devicePixelRatio = screens[i]->devicePixelRatio();
+        screenInfo.push_back(info);
+    }
+}
+
 Vector<QString> LayoutSaver::Layout::mainWindowNames() const
 {
     Vector<QString> names;
@@ -1062,6 +2281,21 @@ LayoutSaver::DockWidget::Ptr LayoutSaver::Group::singleDockWidget() const
     return dockWidgets.first();
 }
 
+LayoutSaver::DockWidget::Ptr LayoutSaver::DockWidget::dockWidgetForName(const QString &name)
+{
+    auto &dockWidgets = t_dockWidgetsBeingPrepared ? *t_dockWidgetsBeingPrepared : s_dockWidgets;
+    auto it = dockWidgets.find(name);
+    auto dw = it == dockWidgets.cend() ? nullptr : it->second;
+    if (dw)
+        return dw;
+
+    dw = Ptr(new LayoutSaver::DockWidget);
+    dockWidgets[name] = dw;
+    dw->uniqueName = name;
+
+    return dw;
+}
+
 bool LayoutSaver::DockWidget::isValid() const
 {
     return !uniqueName.isEmpty();
@@ -1135,9 +2369,39 @@ void LayoutSaver::MainWindow::scaleSizes()
     scalingInfo = ScalingInfo(uniqueName, geometry, screenIndex);
 }
 
+/// Returns whether the items in the layout @p item, and @p item itself, only refer to groups
+/// in @p groupIds. Restoring an item whose group doesn't exist would leave it without a guest.
+static bool itemGuestsExist(const nlohmann::json &item, const std::unordered_set<QString> &groupIds)
+{
+    auto guestId = item.find("guestId");
+    if (guestId != item.end() && guestId->is_string()) {
+        const QString id = guestId->get<QString>();
+        if (!id.isEmpty() && groupIds.count(id) == 0) {
+            KDDW_ERROR("Layout item refers to unknown group {}", id);
+            return false;
+        }
+    }
+
+    auto children = item.find("children");
+    if (children == item.end() || !children->is_array())
+        return true;
+
+    return std::all_of(children->cbegin(), children->cend(), [&groupIds](const nlohmann::json &child) {
+        return !child.is_object() || itemGuestsExist(child, groupIds);
+    });
+}
+
 bool LayoutSaver::MultiSplitter::isValid() const
 {
-    return layout.is_object() && !layout.empty();
+    if (!layout.is_object() || layout.empty())
+        return false;
+
+    std::unordered_set<QString> groupIds;
+    groupIds.reserve(groups.size());
+    for (const auto &it : groups)
+        groupIds.insert(it.second.id);
+
+    return itemGuestsExist(layout, groupIds);
 }
 
 bool LayoutSaver::MultiSplitter::hasSingleDockWidget() const
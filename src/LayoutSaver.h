@@ -23,6 +23,9 @@
 
 #include "kddockwidgets/KDDockWidgets.h"
 
+#include <cstdint>
+#include <memory>
+
 QT_BEGIN_NAMESPACE
 class QByteArray;
 QT_END_NAMESPACE
@@ -39,7 +42,7 @@ class DockWidget;
  * @brief LayoutSaver allows to save or restore layouts.
  *
  * You can save a layout to a file or to a byte array.
- * JSON is used as the serialized format.
+ * JSON is used as the serialized format, unless CBOR is requested via setFormat().
  *
  * Example:
  *     LayoutSaver saver;
@@ -83,6 +86,42 @@ public:
      */
     QByteArray serializeLayout() const;
 
+    /**
+     * @brief Sets the format used by serializeLayout() and saveToFile()
+     * The default is LayoutSaverFormat::Json. Use LayoutSaverFormat::Cbor if the layout is saved
+     * often, for example for crash recovery, and doesn't need to be human readable.
+     *
+     * Restoring doesn't need this to be set, the format is detected automatically.
+     */
+    void setFormat(LayoutSaverFormat);
+
+    ///@brief Returns the format set with setFormat()
+    LayoutSaverFormat format() const;
+
+    /**
+     * @brief Like serializeLayout(), but only includes what changed since the previous call
+     *
+     * Meant for frequent autosaves of big workspaces, where serializing everything each time
+     * is too expensive. The first call includes everything. Main windows and dock widgets which
+     * didn't change since the previous call are omitted. Floating windows are either all included
+     * or none.
+     *
+     * The delta is not a layout, use applyLayoutDelta() to merge it into the previous snapshot.
+     * applyLayoutDelta({}, firstDelta) returns a full layout.
+     *
+     * Each LayoutSaver instance tracks its own changes, so use the same instance for all deltas.
+     */
+    QByteArray serializeLayoutDelta();
+
+    /**
+     * @brief Applies a @p delta obtained with serializeLayoutDelta() to the @p base layout
+     *
+     * @p base can be empty, or the result of a previous applyLayoutDelta() call.
+     * @return the resulting layout, which can be passed to restoreLayout(), or an empty array
+     * if @p delta doesn't apply to @p base.
+     */
+    static QByteArray applyLayoutDelta(const QByteArray &base, const QByteArray &delta);
+
     /**
      * @brief restores the layout from a byte array
      * All MainWindows and DockWidgets should have been created before calling
@@ -97,6 +136,27 @@ public:
      */
     bool restoreLayout(const QByteArray &);
 
+    struct Layout;
+
+    /**
+     * @brief Parses and validates a serialized layout, without restoring it
+     *
+     * Doesn't touch any window or dock widget, so, unlike restoreLayout(), can be called from
+     * a worker thread. Allows big layouts to be parsed while the application is still
+     * initializing. Pass the result to restoreLayout() in the GUI thread.
+     *
+     * @return the parsed layout, or nullptr if @p data is not a valid layout
+     */
+    static std::shared_ptr<Layout> prepareLayout(const QByteArray &data);
+
+    /**
+     * @brief Restores a layout obtained with prepareLayout()
+     * Must be called in the GUI thread. A prepared layout can only be restored once.
+     *
+     * @return true on success
+     */
+    bool restoreLayout(const std::shared_ptr<Layout> &);
+
     /**
      * @brief returns a list of dock widgets which were restored since the last
      * @ref restoreLayout() or @ref restoreFromFile()
@@ -106,6 +166,65 @@ public:
      */
     Vector<Core::DockWidget *> restoredDockWidgets() const;
 
+    /**
+     * @brief How long each phase of a restoreLayout() call took and what it created
+     *
+     * Objects are counted when created, objects deleted during the same phase are still counted.
+     */
+    struct DOCKS_EXPORT RestoreProfile
+    {
+        enum class Phase {
+            Parse = 0, ///< Parsing the serialized layout. 0 for layouts from prepareLayout()
+            Validate, ///< Checking the parsed layout is valid. 0 for layouts from prepareLayout()
+            ScaleSizes, ///< Adapting sizes to the current main windows and screens
+            FloatUnknownDockWidgets, ///< Floating the dock widgets which the layout doesn't restore
+            ClearRegistry, ///< Closing and unparenting the dock widgets about to be restored
+            MainWindows, ///< Restoring main windows and their layouts
+            FloatingWindows, ///< Restoring floating windows
+            ClosedDockWidgets, ///< Restoring geometry and placeholders of closed dock widgets
+            Placeholders, ///< Restoring each dock widget's last position
+            Count
+        };
+
+        struct PhaseStats
+        {
+            int64_t durationUs = 0;
+            int numGroupsCreated = 0;
+            int numItemsCreated = 0; ///< Layout items, containers included
+            int numSeparatorsCreated = 0;
+        };
+
+        /// Returns the stats for @p phase
+        const PhaseStats &stats(Phase phase) const;
+        PhaseStats &stats(Phase phase);
+
+        /// Returns the sum of all phase durations
+        int64_t totalDurationUs() const;
+
+        /// Returns the profile as JSON, one entry per phase
+        QByteArray toJson() const;
+
+        static const char *phaseName(Phase);
+
+        /// False if no restore was profiled yet
+        bool isValid = false;
+
+    private:
+        PhaseStats m_stats[int(Phase::Count)];
+    };
+
+    /**
+     * @brief Enables profiling restoreLayout() and restoreFromFile()
+     *
+     * Disabled by default. Use lastRestoreProfile() to get the results.
+     */
+    void setRestoreProfilingEnabled(bool);
+    bool restoreProfilingEnabled() const;
+
+    /// @brief Returns the profile of the last restore done with this instance, if profiling was
+    /// enabled
+    RestoreProfile lastRestoreProfile() const;
+
     /**
      * @brief Sets the list of affinity names for which restore and save will be applied on.
      * Allows to save/restore only a subset of the windows.
@@ -130,7 +249,6 @@ public:
     class Private;
     Private *dptr() const;
 
-    struct Layout;
     struct MainWindow;
     struct FloatingWindow;
     struct DockWidget;
@@ -13,6 +13,7 @@
 #include "Controller_p.h"
 #include "Platform.h"
 #include "DelayedCall_p.h"
+#include "Platform_p.h"
 #include "View.h"
 #include "Config.h"
 #include "View_p.h"
@@ -158,7 +159,7 @@ void Controller::destroyLater()
 #endif
 
     // Path for Flutter and QTBUG-83030:
-    Platform::instance()->runDelayed(0, new DelayedDelete(this));
+    Platform::instance()->d->delayedCallQueue.schedule(0, new DelayedDelete(this));
 }
 
 Controller::Private *Controller::dptr() const
@@ -14,11 +14,22 @@
 #include "Controller.h"
 #include "DragController_p.h"
 #include "core/Utils_p.h"
+#include "core/Platform_p.h"
 
 using namespace KDDockWidgets::Core;
 
 DelayedCall::~DelayedCall() = default;
 
+const void *DelayedCall::target() const
+{
+    return nullptr;
+}
+
+bool DelayedCall::isDuplicateOf(const DelayedCall &) const
+{
+    return false;
+}
+
 
 DelayedDelete::DelayedDelete(Controller *c)
     : m_object(c)
@@ -32,7 +43,7 @@ void DelayedDelete::call()
 {
     if (isWayland() && DragController::instance()->isInQDrag()) {
         // Workaround QTBUG-115527. FloatingWindow must be deleted after QDrag::exec() ends.
-        Platform::instance()->runDelayed(200, new DelayedDelete(m_object));
+        Platform::instance()->d->delayedCallQueue.schedule(200, new DelayedDelete(m_object));
         return;
     }
 
@@ -41,6 +52,17 @@ void DelayedDelete::call()
     delete m_object;
 }
 
+const void *DelayedDelete::target() const
+{
+    return m_object.data();
+}
+
+bool DelayedDelete::isDuplicateOf(const DelayedCall &other) const
+{
+    auto otherDelete = dynamic_cast<const DelayedDelete *>(&other);
+    return otherDelete && m_object && otherDelete->m_object.data() == m_object.data();
+}
+
 
 DelayedEmitFocusChanged::DelayedEmitFocusChanged(DockWidget *dw, bool focused)
     : m_dockWidget(dw)
@@ -56,3 +78,84 @@ void DelayedEmitFocusChanged::call()
         m_dockWidget->d->isFocusedChanged.emit(m_focused);
     }
 }
+
+const void *DelayedEmitFocusChanged::target() const
+{
+    return m_dockWidget.data();
+}
+
+bool DelayedEmitFocusChanged::isDuplicateOf(const DelayedCall &other) const
+{
+    // Only the same focus state is redundant, the listeners still need to see each transition
+    auto otherEmit = dynamic_cast<const DelayedEmitFocusChanged *>(&other);
+    return otherEmit && m_dockWidget && otherEmit->m_dockWidget.data() == m_dockWidget.data()
+        && otherEmit->m_focused == m_focused;
+}
+
+/// The single platform callback for a whole batch
+class DelayedCallQueue::Flush : public DelayedCall
+{
+public:
+    explicit Flush(int ms)
+        : m_ms(ms)
+    {
+    }
+
+    void call() override
+    {
+        if (auto platform = Platform::instance())
+            platform->d->delayedCallQueue.flush(m_ms);
+    }
+
+private:
+    const int m_ms;
+};
+
+DelayedCallQueue::DelayedCallQueue() = default;
+DelayedCallQueue::~DelayedCallQueue() = default;
+
+void DelayedCallQueue::schedule(int ms, DelayedCall *call)
+{
+    std::unique_ptr<DelayedCall> c(call);
+
+    auto it = m_batches.find(ms);
+    const bool isNewBatch = it == m_batches.end();
+    if (isNewBatch)
+        it = m_batches.emplace(ms, Batch()).first;
+
+    Batch &batch = it->second;
+    if (const void *target = c->target()) {
+        DelayedCall *&last = batch.lastCallByTarget[target];
+        if (last && c->isDuplicateOf(*last))
+            return;
+        last = c.get();
+    }
+
+    batch.calls.push_back(std::move(c));
+
+    if (isNewBatch)
+        Platform::instance()->runDelayed(ms, new Flush(ms));
+}
+
+void DelayedCallQueue::flush(int ms)
+{
+    auto it = m_batches.find(ms);
+    if (it == m_batches.end())
+        return;
+
+    // Calls scheduled from now on go into a new batch, with its own platform callback
+    Batch batch = std::move(it->second);
+    m_batches.erase(it);
+
+    for (const auto &c : batch.calls)
+        c->call();
+}
+
+int DelayedCallQueue::numPendingCalls() const
+{
+    int count = 0;
+    for (const auto &it : m_batches)
+        count += int(it.second.calls.size());
+
+    return count;
+}
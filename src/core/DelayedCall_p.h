@@ -14,6 +14,10 @@
 #include "KDDockWidgets.h"
 #include "ObjectGuard_p.h"
 
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
 namespace KDDockWidgets::Core {
 
 class DockWidget;
@@ -26,6 +30,13 @@ public:
     virtual ~DelayedCall();
     virtual void call() = 0;
 
+    /// Returns the object this call acts on, if any. See isDuplicateOf().
+    virtual const void *target() const;
+
+    /// Returns whether this call is redundant if it runs right after @p other.
+    /// Only called if both have the same target(). Used by DelayedCallQueue to collapse calls.
+    virtual bool isDuplicateOf(const DelayedCall &other) const;
+
     KDDW_DELETE_COPY_CTOR(DelayedCall)
 };
 
@@ -36,6 +47,8 @@ public:
     ~DelayedDelete() override;
 
     void call() override;
+    const void *target() const override;
+    bool isDuplicateOf(const DelayedCall &other) const override;
 
     KDDW_DELETE_COPY_CTOR(DelayedDelete)
 private:
@@ -49,6 +62,8 @@ public:
     ~DelayedEmitFocusChanged() override;
 
     void call() override;
+    const void *target() const override;
+    bool isDuplicateOf(const DelayedCall &other) const override;
 
     KDDW_DELETE_COPY_CTOR(DelayedEmitFocusChanged)
 private:
@@ -56,4 +71,35 @@ private:
     const bool m_focused;
 };
 
+/// Batches DelayedCalls, so bursts of them (closing many dock widgets, restoring a layout)
+/// don't result in one platform timer each. All calls with the same delay which are scheduled
+/// before their batch runs share a single Platform::runDelayed(), and run in the order they
+/// were scheduled. A call which is a duplicate of the previous call for the same target, in the
+/// same batch, is dropped.
+class DelayedCallQueue
+{
+public:
+    DelayedCallQueue();
+    ~DelayedCallQueue();
+
+    /// Runs @p call after @p ms. Takes ownership of @p call
+    void schedule(int ms, DelayedCall *call);
+
+    /// Returns the number of calls waiting to run. For tests.
+    int numPendingCalls() const;
+
+    KDDW_DELETE_COPY_CTOR(DelayedCallQueue)
+private:
+    class Flush;
+    void flush(int ms);
+
+    struct Batch
+    {
+        std::vector<std::unique_ptr<DelayedCall>> calls;
+        std::unordered_map<const void *, DelayedCall *> lastCallByTarget;
+    };
+
+    std::unordered_map<int, Batch> m_batches;
+};
+
 }
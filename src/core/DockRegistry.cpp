@@ -37,6 +37,10 @@
 #include <set>
 #include <utility>
 
+#ifdef KDDockWidgets_XLIB
+#include "core/WindowZOrder_x11_p.h"
+#endif
+
 using namespace KDDockWidgets;
 using namespace KDDockWidgets::Core;
 
@@ -88,27 +92,66 @@ void DockRegistry::maybeDelete()
 
 void DockRegistry::onFocusedViewChanged(std::shared_ptr<View> view)
 {
-    auto p = view;
-    while (p && !p->isNull()) {
-        if (auto group = p->asGroupController()) {
-            // Special case: The focused widget is inside the group but not inside the dockwidget.
-            // For example, it's a line edit in the QTabBar. We still need to send the signal for
-            // the current dw in the tab group
-            if (auto dw = group->currentDockWidget()) {
-                setFocusedDockWidget(dw);
+    // Walks the ancestors once, for both the focused dock widget and the focus scopes
+    bool dockWidgetFound = false;
+    Core::DockWidget *focusedDockWidget = nullptr;
+    Vector<Private::FocusScopeEntry> focusedScopes;
+
+    for (auto p = view; p && !p->isNull(); p = p->parentView()) {
+        if (!dockWidgetFound) {
+            if (auto group = p->asGroupController()) {
+                // Special case: The focused widget is inside the group but not inside the dockwidget.
+                // For example, it's a line edit in the QTabBar. We still need to send the signal for
+                // the current dw in the tab group. If there's no current dw, nothing changes.
+                dockWidgetFound = true;
+                focusedDockWidget = group->currentDockWidget();
+                if (!focusedDockWidget)
+                    focusedDockWidget = d->m_focusedDockWidget;
+            } else if (auto dw = p->asDockWidgetController()) {
+                dockWidgetFound = true;
+                focusedDockWidget = dw;
             }
-
-            return;
         }
 
-        if (auto dw = p->asDockWidgetController()) {
-            DockRegistry::self()->setFocusedDockWidget(dw);
-            return;
-        }
-        p = p->parentView();
+        auto it = d->m_focusScopesByHandle.find(p->handle());
+        if (it != d->m_focusScopesByHandle.cend())
+            focusedScopes.push_back(*it);
+    }
+
+    setFocusedDockWidget(focusedDockWidget);
+
+    // Only scopes which lost focus or which contain the focused view are notified.
+    // Callbacks might delete scopes, so check they're still registered.
+    const Vector<Private::FocusScopeEntry> previousScopes = std::exchange(d->m_focusedScopes, focusedScopes);
+    auto isRegistered = [this](const Private::FocusScopeEntry &entry) {
+        auto it = d->m_focusScopesByHandle.find(entry.first);
+        return it != d->m_focusScopesByHandle.cend() && it->second == entry.second;
+    };
+
+    for (const auto &entry : previousScopes) {
+        if (!focusedScopes.contains(entry) && isRegistered(entry))
+            entry.second->onFocusedViewChanged(view, /*isInScope=*/false);
     }
 
-    setFocusedDockWidget(nullptr);
+    for (const auto &entry : std::as_const(focusedScopes)) {
+        if (isRegistered(entry))
+            entry.second->onFocusedViewChanged(view, /*isInScope=*/true);
+    }
+}
+
+void DockRegistry::registerFocusScope(Core::FocusScope *scope, Core::HANDLE handle)
+{
+    d->m_focusScopesByHandle[handle] = scope;
+    if (scope->isFocused())
+        d->m_focusedScopes.push_back({ handle, scope });
+}
+
+void DockRegistry::unregisterFocusScope(Core::FocusScope *scope, Core::HANDLE handle)
+{
+    auto it = d->m_focusScopesByHandle.find(handle);
+    if (it != d->m_focusScopesByHandle.end() && it->second == scope)
+        d->m_focusScopesByHandle.erase(it);
+    d->m_focusedScopes.removeAll(Private::FocusScopeEntry { handle, scope });
 }
 
 void DockRegistry::setFocusedDockWidget(Core::DockWidget *dw)
@@ -298,6 +341,29 @@ bool DockRegistry::itemIsInMainWindow(const Item *item) const
     return false;
 }
 
+/// Removes @p obj from the name index, called after @p obj was removed from @p list or renamed
+/// If there was another object with the same name (error condition), it takes over the index entry
+template<typename T>
+static void removeFromNameIndex(std::unordered_map<QString, T *> &index, const Vector<T *> &list,
+                                T *obj, const QString &name)
+{
+    auto it = index.find(name);
+    if (it == index.end() || it->second != obj)
+        return;
+
+    index.erase(it);
+
+    if (list.size() > int(index.size())) {
+        // Not all objects are indexed, meaning there's duplicates
+        for (T *other : list) {
+            if (other != obj && other->uniqueName() == name) {
+                index.emplace(name, other);
+                break;
+            }
+        }
+    }
+}
+
 DockRegistry *DockRegistry::self()
 {
     static ObjectGuard<DockRegistry> s_dockRegistry;
@@ -318,6 +384,7 @@ void DockRegistry::registerDockWidget(Core::DockWidget *dock)
     }
 
     m_dockWidgets.push_back(dock);
+    d->m_dockWidgetsByName.emplace(dock->uniqueName(), dock);
 }
 
 void DockRegistry::unregisterDockWidget(Core::DockWidget *dock)
@@ -326,11 +393,26 @@ void DockRegistry::unregisterDockWidget(Core::DockWidget *dock)
         d->m_focusedDockWidget = nullptr;
 
     m_dockWidgets.removeOne(dock);
+    removeFromNameIndex(d->m_dockWidgetsByName, m_dockWidgets, dock, dock->uniqueName());
     m_sideBarGroupings->removeFromGroupings(dock);
 
     maybeDelete();
 }
 
+void DockRegistry::onDockWidgetRenamed(Core::DockWidget *dock, const QString &oldName)
+{
+    if (!m_dockWidgets.contains(dock))
+        return;
+
+    removeFromNameIndex(d->m_dockWidgetsByName, m_dockWidgets, dock, oldName);
+
+    // The name can be taken temporarily, for example when swapping the names of two docks.
+    // The other dock keeps the entry, and hands it over when it's renamed as well.
+    auto result = d->m_dockWidgetsByName.emplace(dock->uniqueName(), dock);
+    if (!result.second && result.first->second->uniqueName() != dock->uniqueName())
+        result.first->second = dock;
+}
+
 void DockRegistry::registerMainWindow(Core::MainWindow *mainWindow)
 {
     if (mainWindow->uniqueName().isEmpty()) {
@@ -340,12 +422,14 @@ void DockRegistry::registerMainWindow(Core::MainWindow *mainWindow)
     }
 
     m_mainWindows.push_back(mainWindow);
+    d->m_mainWindowsByName.emplace(mainWindow->uniqueName(), mainWindow);
     Platform::instance()->onMainWindowCreated(mainWindow);
 }
 
 void DockRegistry::unregisterMainWindow(Core::MainWindow *mainWindow)
 {
     m_mainWindows.removeOne(mainWindow);
+    removeFromNameIndex(d->m_mainWindowsByName, m_mainWindows, mainWindow, mainWindow->uniqueName());
     Platform::instance()->onMainWindowDestroyed(mainWindow);
     maybeDelete();
 }
@@ -402,9 +486,15 @@ bool DockRegistry::containsMainWindow(const QString &uniqueName) const
 
 Core::DockWidget *DockRegistry::dockByName(const QString &name, DockByNameFlags flags) const
 {
-    for (auto dock : std::as_const(m_dockWidgets)) {
-        if (dock->uniqueName() == name)
-            return dock;
+    auto dockIt = d->m_dockWidgetsByName.find(name);
+    if (dockIt != d->m_dockWidgetsByName.cend()) {
+        if (dockIt->second->uniqueName() == name)
+            return dockIt->second;
+
+        // Registering, unregistering and renaming keep the index up to date
+        KDDW_ERROR("DockRegistry::dockByName: Stale index entry for {}, got {}", name,
+                   dockIt->second->uniqueName());
+        assert(false);
     }
 
     if (flags.testFlag(DockByNameFlag::ConsultRemapping)) {
@@ -436,12 +526,8 @@ Core::DockWidget *DockRegistry::dockByName(const QString &name, DockByNameFlags
 
 Core::MainWindow *DockRegistry::mainWindowByName(const QString &name) const
 {
-    for (auto mainWindow : std::as_const(m_mainWindows)) {
-        if (mainWindow->uniqueName() == name)
-            return mainWindow;
-    }
-
-    return nullptr;
+    auto it = d->m_mainWindowsByName.find(name);
+    return it == d->m_mainWindowsByName.cend() ? nullptr : it->second;
 }
 
 bool DockRegistry::isSane() const
@@ -460,6 +546,9 @@ bool DockRegistry::isSane() const
         }
     }
 
+    // Checking layouts visits every item, which is what's expensive, so sample it as a whole
+    const bool checkLayouts = Core::Item::shouldCheckLayoutSanity();
+
     names.clear();
     for (auto mainwindow : std::as_const(m_mainWindows)) {
         const QString name = mainwindow->uniqueName();
@@ -473,7 +562,7 @@ bool DockRegistry::isSane() const
             names.insert(name);
         }
 
-        if (!mainwindow->layout()->checkSanity())
+        if (checkLayouts && !mainwindow->layout()->checkSanity())
             return false;
     }
 
@@ -768,6 +857,12 @@ bool DockRegistry::onExposeEvent(Core::Window::Ptr window)
         // This floating window was exposed
         m_floatingWindows.removeOne(fw);
         m_floatingWindows.append(fw);
+
+#ifdef KDDockWidgets_XLIB
+        // It might have been mapped or raised without us seeing a restack
+        if (linksToXLib() && isXCB())
+            WindowZOrder::self().invalidate();
+#endif
     }
 
     return false;
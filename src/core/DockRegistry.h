@@ -63,6 +63,9 @@ public:
     void registerDockWidget(Core::DockWidget *);
     void unregisterDockWidget(Core::DockWidget *);
 
+    ///@brief Called by DockWidget when its unique name changed, so lookup by name still works
+    void onDockWidgetRenamed(Core::DockWidget *, const QString &oldName);
+
     void registerMainWindow(Core::MainWindow *);
     void unregisterMainWindow(Core::MainWindow *);
 
@@ -233,6 +236,8 @@ private:
     explicit DockRegistry(Core::Object *parent = nullptr);
     bool onDockWidgetPressed(Core::DockWidget *dw, MouseEvent *);
     void onFocusedViewChanged(std::shared_ptr<Core::View> view);
+    void registerFocusScope(Core::FocusScope *, Core::HANDLE);
+    void unregisterFocusScope(Core::FocusScope *, Core::HANDLE);
     void maybeDelete();
     void setFocusedDockWidget(Core::DockWidget *);
 
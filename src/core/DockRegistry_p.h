@@ -11,9 +11,12 @@
 
 #include "DockRegistry.h"
 #include "ObjectGuard_p.h"
+#include "View.h"
 
 #include <kdbindings/signal.h>
 
+#include <unordered_map>
+
 
 #pragma once
 
@@ -40,7 +43,20 @@ public:
 
     int m_numLayoutSavers = 0;
 
+    /// Indexes for dockByName() and mainWindowByName(), as LayoutSaver does a lookup per dock widget.
+    /// If there are duplicate names (which is an error), the first one registered wins, like before.
+    std::unordered_map<QString, Core::DockWidget *> m_dockWidgetsByName;
+    std::unordered_map<QString, Core::MainWindow *> m_mainWindowsByName;
+
     CloseReason m_currentCloseReason = CloseReason::Unspecified;
+
+    /// Focus scopes by the handle of their view. A focus change walks the focused view's ancestors
+    /// once and looks them up here, instead of each scope walking them.
+    std::unordered_map<Core::HANDLE, Core::FocusScope *> m_focusScopesByHandle;
+
+    /// The scopes containing the focused view, innermost first
+    using FocusScopeEntry = std::pair<Core::HANDLE, Core::FocusScope *>;
+    Vector<FocusScopeEntry> m_focusedScopes;
 };
 
 }
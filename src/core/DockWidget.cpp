@@ -1183,8 +1183,10 @@ void DockWidget::Private::setUniqueName(const QString &name)
 {
     if (name.isEmpty()) {
         KDDW_ERROR("DockWidget::Private::setUniqueName: Name is empty");
-    } else {
+    } else if (name != m_uniqueName) {
+        const QString oldName = m_uniqueName;
         m_uniqueName = name;
+        DockRegistry::self()->onDockWidgetRenamed(q, oldName);
     }
 }
 
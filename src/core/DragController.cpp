@@ -26,6 +26,7 @@
 #include "core/FloatingWindow.h"
 #include "core/DockWidget_p.h"
 #include "core/ScopedValueRollback_p.h"
+#include "core/DragTracer.h"
 
 #ifdef KDDW_FRONTEND_QT
 #include "../qtcommon/DragControllerWayland_p.h"
@@ -169,7 +170,7 @@ StateNone::StateNone(DragController *parent)
 
 void StateNone::onEntry()
 {
-    KDDW_DEBUG("StateNone entered");
+    KDDW_DEBUG_CAT(DRAG, "StateNone entered");
     q->m_pressPos = Point();
     q->m_offset = Point();
     q->m_draggable = nullptr;
@@ -194,7 +195,7 @@ void StateNone::onEntry()
 // NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
 bool StateNone::handleMouseButtonPress(Draggable *draggable, Point globalPos, Point pos)
 {
-    KDDW_DEBUG("StateNone::handleMouseButtonPress: draggable={} ; globalPos={}", ( void * )draggable,
+    KDDW_DEBUG_CAT(DRAG, "StateNone::handleMouseButtonPress: draggable={} ; globalPos={}", ( void * )draggable,
                globalPos);
 
     if (!draggable) {
@@ -226,7 +227,7 @@ StatePreDrag::~StatePreDrag() = default;
 
 void StatePreDrag::onEntry()
 {
-    KDDW_DEBUG("StatePreDrag entered {}", q->m_draggableGuard.isNull());
+    KDDW_DEBUG_CAT(DRAG, "StatePreDrag entered {}", q->m_draggableGuard.isNull());
     WidgetResizeHandler::s_disableAllHandlers = true; // Disable the resize handler during dragging
 }
 
@@ -280,7 +281,7 @@ StateDragging::StateDragging(DragController *parent)
 
         const bool mouseButtonIsReallyDown = (GetKeyState(VK_LBUTTON) & 0x8000);
         if (!mouseButtonIsReallyDown && Platform::instance()->isLeftMouseButtonPressed()) {
-            KDDW_DEBUG("Canceling drag, Qt thinks mouse button is pressed"
+            KDDW_DEBUG_CAT(DRAG, "Canceling drag, Qt thinks mouse button is pressed"
                        "but Windows knows it's not");
             handleMouseButtonRelease(Platform::instance()->cursorPos());
             q->dragCanceled.emit();
@@ -310,6 +311,13 @@ void StateDragging::onEntry()
             dw->d->saveLastFloatingGeometry();
     }
 
+#ifdef KDDockWidgets_XLIB
+    // Top-levels might have been restacked since the last drag. The z-order is queried once,
+    // not on every mouse move.
+    if (linksToXLib() && isXCB())
+        WindowZOrder::self().invalidate();
+#endif
+
     const bool needsUndocking = !q->m_draggable->isWindow();
     q->m_windowBeingDragged = q->m_draggable->makeWindow();
     if (q->m_windowBeingDragged) {
@@ -339,7 +347,7 @@ void StateDragging::onEntry()
         KDDW_UNUSED(needsUndocking);
 #endif
 
-        KDDW_DEBUG("StateDragging entered. m_draggable={}; m_windowBeingDragged={}", ( void * )q->m_draggable, ( void * )q->m_windowBeingDragged->floatingWindow());
+        KDDW_DEBUG_CAT(DRAG, "StateDragging entered. m_draggable={}; m_windowBeingDragged={}", ( void * )q->m_draggable, ( void * )q->m_windowBeingDragged->floatingWindow());
 
         auto fw = q->m_windowBeingDragged->floatingWindow();
 #ifdef Q_OS_LINUX
@@ -406,18 +414,18 @@ void StateDragging::onExit()
 
 bool StateDragging::handleMouseButtonRelease(Point globalPos)
 {
-    KDDW_DEBUG("StateDragging: handleMouseButtonRelease");
+    KDDW_DEBUG_CAT(DRAG, "StateDragging: handleMouseButtonRelease");
 
     FloatingWindow *floatingWindow = q->m_windowBeingDragged->floatingWindow();
     if (!floatingWindow) {
         // It was deleted externally
-        KDDW_DEBUG("StateDragging: Bailling out, deleted externally");
+        KDDW_DEBUG_CAT(DRAG, "StateDragging: Bailling out, deleted externally");
         q->dragCanceled.emit();
         return true;
     }
 
     if (floatingWindow->anyNonDockable()) {
-        KDDW_DEBUG("StateDragging: Ignoring floating window with non dockable widgets");
+        KDDW_DEBUG_CAT(DRAG, "StateDragging: Ignoring floating window with non dockable widgets");
         q->dragCanceled.emit();
         return true;
     }
@@ -426,11 +434,11 @@ bool StateDragging::handleMouseButtonRelease(Point globalPos)
         if (q->m_currentDropArea->drop(q->m_windowBeingDragged.get(), globalPos)) {
             q->dropped.emit();
         } else {
-            KDDW_DEBUG("StateDragging: Bailling out, drop not accepted");
+            KDDW_DEBUG_CAT(DRAG, "StateDragging: Bailling out, drop not accepted");
             q->dragCanceled.emit();
         }
     } else {
-        KDDW_DEBUG("StateDragging: Bailling out, not over a drop area");
+        KDDW_DEBUG_CAT(DRAG, "StateDragging: Bailling out, not over a drop area");
         q->dragCanceled.emit();
     }
     return true;
@@ -438,9 +446,10 @@ bool StateDragging::handleMouseButtonRelease(Point globalPos)
 
 bool StateDragging::handleMouseMove(Point globalPos)
 {
+    DragTracer::Scope trace(DragTracer::Stage::MouseMove);
     FloatingWindow *fw = q->m_windowBeingDragged->floatingWindow();
     if (!fw) {
-        KDDW_DEBUG("Canceling drag, window was deleted");
+        KDDW_DEBUG_CAT(DRAG, "Canceling drag, window was deleted");
         q->dragCanceled.emit();
         return true;
     }
@@ -468,7 +477,7 @@ bool StateDragging::handleMouseMove(Point globalPos)
         fw->view()->window()->setFramePosition(globalPos - q->m_offset);
 
     if (fw->anyNonDockable()) {
-        KDDW_DEBUG("StateDragging: Ignoring non dockable floating window");
+        KDDW_DEBUG_CAT(DRAG, "StateDragging: Ignoring non dockable floating window");
         return true;
     }
 
@@ -479,7 +488,7 @@ bool StateDragging::handleMouseMove(Point globalPos)
     if (dropArea) {
         if (FloatingWindow *targetFw = dropArea->floatingWindow()) {
             if (targetFw->anyNonDockable()) {
-                KDDW_DEBUG("StateDragging: Ignoring non dockable target floating window");
+                KDDW_DEBUG_CAT(DRAG, "StateDragging: Ignoring non dockable target floating window");
                 return false;
             }
         }
@@ -511,7 +520,7 @@ StateInternalMDIDragging::~StateInternalMDIDragging()
 
 void StateInternalMDIDragging::onEntry()
 {
-    KDDW_DEBUG("StateInternalMDIDragging entered. draggable={}", ( void * )q->m_draggable);
+    KDDW_DEBUG_CAT(DRAG, "StateInternalMDIDragging entered. draggable={}", ( void * )q->m_draggable);
 
     if (!q->m_draggableGuard) {
         KDDW_ERROR("Draggable was destroyed, canceling the drag");
@@ -719,7 +728,7 @@ bool DragController::onDnDEvent(View *view, Event *e)
 
     // Wayland is very different. It uses QDrag for the dragging of a window.
     if (view) {
-        KDDW_DEBUG("DragController::onDnDEvent: ev={}, dropArea=", int(e->type()), ( void * )view->asDropAreaController());
+        KDDW_DEBUG_CAT(DRAG, "DragController::onDnDEvent: ev={}, dropArea=", int(e->type()), ( void * )view->asDropAreaController());
         if (auto dropArea = view->asDropAreaController()) {
             switch (int(e->type())) {
             case Event::DragEnter:
@@ -742,10 +751,10 @@ bool DragController::onDnDEvent(View *view, Event *e)
         }
     } else if (e->type() == Event::DragEnter && isDragging()) {
         // We're dragging a window. Be sure user code doesn't accept DragEnter events.
-        KDDW_DEBUG("DragController::onDnDEvent: Eating DragEnter.");
+        KDDW_DEBUG_CAT(DRAG, "DragController::onDnDEvent: Eating DragEnter.");
         return true;
     } else {
-        KDDW_DEBUG("DragController::onDnDEvent: No view. ev={}", int(e->type()));
+        KDDW_DEBUG_CAT(DRAG, "DragController::onDnDEvent: No view. ev={}", int(e->type()));
     }
 
     return false;
@@ -755,7 +764,7 @@ bool DragController::onMoveEvent(View *)
 {
     if (m_nonClientDrag) {
         // On Windows, non-client mouse moves are only sent at the end, so we must fake it:
-        KDDW_TRACE("DragController::onMoveEvent");
+        KDDW_TRACE_THROTTLED_CAT(DRAG, "DragController::onMoveEvent");
         activeState()
             ->handleMouseMove(Platform::instance()->cursorPos());
     }
@@ -768,7 +777,10 @@ bool DragController::onMouseEvent(View *w, MouseEvent *me)
     if (!w)
         return false;
 
-    KDDW_TRACE("DragController::onMouseEvent e={} ; nonClientDrag={}", int(me->type()), m_nonClientDrag);
+    // Mouse events while not dragging aren't interesting
+    DragTracer::Scope trace(DragTracer::Stage::MouseEvent, !isIdle());
+
+    KDDW_TRACE_THROTTLED_CAT(DRAG, "DragController::onMouseEvent e={} ; nonClientDrag={}", int(me->type()), m_nonClientDrag);
 
     switch (me->type()) {
     case Event::NonClientAreaMouseButtonPress: {
@@ -921,7 +933,7 @@ static std::shared_ptr<View> qtTopLevelForHWND(HWND hwnd)
         }
     }
 
-    KDDW_TRACE("Couldn't find hwnd for top-level hwnd={}", ( void * )hwnd);
+    KDDW_TRACE_THROTTLED_CAT(DRAG, "Couldn't find hwnd for top-level hwnd={}", ( void * )hwnd);
     return nullptr;
 }
 
@@ -942,7 +954,7 @@ static std::shared_ptr<View> qtTopLevelUnderCursor_impl(Point globalPos,
             continue;
 
         if (window->geometry().contains(globalPos)) {
-            KDDW_TRACE("Found top-level {}", ( void * )tl.get());
+            KDDW_TRACE_THROTTLED_CAT(DRAG, "Found top-level {}", ( void * )tl.get());
             return tl;
         }
     }
@@ -978,7 +990,7 @@ std::shared_ptr<View> DragController::qtTopLevelUnderCursor() const
 
                 if (windowGeometry.contains(globalPos)
                     && tl->viewName() != QStringLiteral("_docks_IndicatorWindow_Overlay")) {
-                    KDDW_TRACE("Found top-level {}", ( void * )tl.get());
+                    KDDW_TRACE_THROTTLED_CAT(DRAG, "Found top-level {}", ( void * )tl.get());
                     return tl;
                 }
             } else {
@@ -993,7 +1005,7 @@ std::shared_ptr<View> DragController::qtTopLevelUnderCursor() const
                                 if (topLevel->rect().contains(topLevel->mapFromGlobal(globalPos))
                                     && topLevel->objectName()
                                         != QStringLiteral("_docks_IndicatorWindow_Overlay")) {
-                                    KDDW_TRACE("Found top-level {}", ( void * )topLevel);
+                                    KDDW_TRACE_THROTTLED_CAT(DRAG, "Found top-level {}", ( void * )topLevel);
                                     return QtCommon::Platform_qt::instance()->qobjectAsView(topLevel);
                                 }
                             }
@@ -1001,7 +1013,7 @@ std::shared_ptr<View> DragController::qtTopLevelUnderCursor() const
                     }
                 }
 #endif // QtWidgets A window belonging to another app is below the cursor
-                KDDW_TRACE("Window from another app is under cursor {}", ( void * )hwnd);
+                KDDW_TRACE_THROTTLED_CAT(DRAG, "Window from another app is under cursor {}", ( void * )hwnd);
                 return nullptr;
             }
         }
@@ -1015,7 +1027,7 @@ std::shared_ptr<View> DragController::qtTopLevelUnderCursor() const
             return tl;
 
         if (!ok) {
-            KDDW_TRACE("No top-level found. Some windows weren't seen by XLib");
+            KDDW_TRACE_THROTTLED_CAT(DRAG, "No top-level found. Some windows weren't seen by XLib");
         }
     } else {
         // !Windows: Linux, macOS, offscreen (offscreen on Windows too), etc.
@@ -1034,7 +1046,7 @@ std::shared_ptr<View> DragController::qtTopLevelUnderCursor() const
             globalPos, DockRegistry::self()->topLevels(/*excludeFloatingDocks=*/true), tlwBeingDragged);
     }
 
-    KDDW_TRACE("No top-level found");
+    KDDW_TRACE_THROTTLED_CAT(DRAG, "No top-level found");
     return nullptr;
 }
 
@@ -1057,12 +1069,13 @@ static DropArea *deepestDropAreaInTopLevel(std::shared_ptr<View> topLevel, Point
 
 DropArea *DragController::dropAreaUnderCursor() const
 {
+    DragTracer::Scope trace(DragTracer::Stage::DropAreaUnderCursor);
     if (!m_windowBeingDragged)
         return nullptr;
 
     std::shared_ptr<View> topLevel = qtTopLevelUnderCursor();
     if (!topLevel) {
-        KDDW_DEBUG("DragController::dropAreaUnderCursor: No drop area under cursor");
+        KDDW_DEBUG_THROTTLED_CAT(DRAG, "DragController::dropAreaUnderCursor: No drop area under cursor");
         return nullptr;
     }
 
@@ -1070,7 +1083,7 @@ DropArea *DragController::dropAreaUnderCursor() const
 
     if (auto fw = topLevel->asFloatingWindowController()) {
         if (DockRegistry::self()->affinitiesMatch(fw->affinities(), affinities)) {
-            KDDW_DEBUG("DragController::dropAreaUnderCursor: Found drop area in floating window");
+            KDDW_DEBUG_THROTTLED_CAT(DRAG, "DragController::dropAreaUnderCursor: Found drop area in floating window");
             return fw->dropArea();
         }
     }
@@ -1081,11 +1094,11 @@ DropArea *DragController::dropAreaUnderCursor() const
     }
 
     if (auto dt = deepestDropAreaInTopLevel(topLevel, Platform::instance()->cursorPos(), affinities)) {
-        KDDW_DEBUG("DragController::dropAreaUnderCursor: Found drop area {} {}", ( void * )dt, ( void * )dt->view()->rootView().get());
+        KDDW_DEBUG_THROTTLED_CAT(DRAG, "DragController::dropAreaUnderCursor: Found drop area {} {}", ( void * )dt, ( void * )dt->view()->rootView().get());
         return dt;
     }
 
-    KDDW_DEBUG("DragController::dropAreaUnderCursor: null2");
+    KDDW_DEBUG_THROTTLED_CAT(DRAG, "DragController::dropAreaUnderCursor: null2");
     return nullptr;
 }
 
@@ -0,0 +1,158 @@
+/*
+  This file is part of KDDockWidgets.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include "DragTracer.h"
+#include "core/Logging_p.h"
+
+#include "nlohmann/json.hpp"
+
+#include <chrono>
+#include <fstream>
+
+using namespace KDDockWidgets;
+using namespace KDDockWidgets::Core;
+
+bool DragTracer::s_enabled = false;
+
+namespace {
+
+struct RingBuffer
+{
+    std::vector<DragTracer::Event> events;
+    size_t capacity = 10000;
+    size_t next = 0; // Where the next event goes, once full
+};
+
+RingBuffer &ringBuffer()
+{
+    static RingBuffer buffer;
+    return buffer;
+}
+
+}
+
+void DragTracer::setEnabled(bool enabled)
+{
+    s_enabled = enabled;
+}
+
+bool DragTracer::isEnabled()
+{
+    return s_enabled;
+}
+
+void DragTracer::setCapacity(int capacity)
+{
+    if (capacity <= 0) {
+        KDDW_ERROR("DragTracer::setCapacity: Invalid capacity {}", capacity);
+        return;
+    }
+
+    clear();
+    ringBuffer().capacity = size_t(capacity);
+}
+
+int DragTracer::capacity()
+{
+    return int(ringBuffer().capacity);
+}
+
+std::vector<DragTracer::Event> DragTracer::events()
+{
+    const RingBuffer &buffer = ringBuffer();
+    if (buffer.events.size() < buffer.capacity)
+        return buffer.events;
+
+    std::vector<Event> result;
+    result.reserve(buffer.events.size());
+    result.insert(result.end(), buffer.events.cbegin() + long(buffer.next), buffer.events.cend());
+    result.insert(result.end(), buffer.events.cbegin(), buffer.events.cbegin() + long(buffer.next));
+    return result;
+}
+
+void DragTracer::clear()
+{
+    RingBuffer &buffer = ringBuffer();
+    buffer.events.clear();
+    buffer.events.shrink_to_fit();
+    buffer.next = 0;
+}
+
+QByteArray DragTracer::toChromeTraceJson()
+{
+    // Complete events ("ph": "X"), see the "Trace Event Format" document
+    nlohmann::json traceEvents = nlohmann::json::array();
+    for (const Event &event : events()) {
+        traceEvents.push_back({ { "name", stageName(event.stage) },
+                                { "cat", "drag" },
+                                { "ph", "X" },
+                                { "ts", event.startUs },
+                                { "dur", event.durationUs },
+                                { "pid", 1 },
+                                { "tid", 1 } });
+    }
+
+    nlohmann::json json;
+    json["traceEvents"] = std::move(traceEvents);
+    json["displayTimeUnit"] = "ms";
+    return QByteArray::fromStdString(json.dump());
+}
+
+bool DragTracer::saveChromeTrace(const QString &filename)
+{
+    std::ofstream file(filename.toStdString(), std::ios::binary);
+    if (!file.is_open()) {
+        KDDW_ERROR("DragTracer::saveChromeTrace: Failed to open {}", filename);
+        return false;
+    }
+
+    const QByteArray data = toChromeTraceJson();
+    file.write(data.constData(), data.size());
+    return file.good();
+}
+
+const char *DragTracer::stageName(Stage stage)
+{
+    switch (stage) {
+    case Stage::MouseEvent:
+        return "DragController::onMouseEvent";
+    case Stage::MouseMove:
+        return "StateDragging::handleMouseMove";
+    case Stage::DropAreaUnderCursor:
+        return "DragController::dropAreaUnderCursor";
+    case Stage::DropAreaHover:
+        return "DropArea::hover";
+    case Stage::IndicatorHover:
+        return "DropIndicatorOverlay::hover";
+    case Stage::Drop:
+        return "DropArea::drop";
+    }
+
+    return "";
+}
+
+int64_t DragTracer::now()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void DragTracer::record(Stage stage, int64_t startUs, int64_t durationUs)
+{
+    RingBuffer &buffer = ringBuffer();
+    const Event event = { stage, startUs, durationUs };
+    if (buffer.events.size() < buffer.capacity) {
+        buffer.events.push_back(event);
+    } else {
+        buffer.events[buffer.next] = event;
+        buffer.next = (buffer.next + 1) % buffer.capacity;
+    }
+}
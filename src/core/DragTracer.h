@@ -0,0 +1,109 @@
+/*
+  This file is part of KDDockWidgets.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+/**
+ * @file
+ * @brief Records how long each stage of a drag takes, to diagnose laggy drags
+ */
+
+#ifndef KD_DOCKWIDGETS_DRAGTRACER_H
+#define KD_DOCKWIDGETS_DRAGTRACER_H
+
+#include "kddockwidgets/docks_export.h"
+#include "kddockwidgets/KDDockWidgets.h"
+#include "kddockwidgets/QtCompat_p.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace KDDockWidgets::Core {
+
+/**
+ * @brief Records how long each stage of the drag and drop pipeline takes
+ *
+ * Disabled by default. When enabled, each mouse event handled by the drag controller is timed,
+ * along with the stages it goes through, like finding the drop area under the cursor and
+ * updating the drop indicators. Events are kept in a fixed size ring buffer, so tracing can be
+ * left enabled. When disabled the cost is a single branch per stage.
+ *
+ * Call saveChromeTrace() after a laggy drag and open the file with chrome://tracing or
+ * https://ui.perfetto.dev
+ */
+class DOCKS_EXPORT DragTracer
+{
+public:
+    enum class Stage {
+        MouseEvent = 0, ///< DragController::onMouseEvent()
+        MouseMove, ///< StateDragging::handleMouseMove()
+        DropAreaUnderCursor, ///< DragController::dropAreaUnderCursor()
+        DropAreaHover, ///< DropArea::hover()
+        IndicatorHover, ///< DropIndicatorOverlay::hover()
+        Drop ///< DropArea::drop()
+    };
+
+    struct Event
+    {
+        Stage stage;
+        int64_t startUs; ///< Steady clock time, in microseconds
+        int64_t durationUs;
+    };
+
+    /// Enables or disables tracing. Disabled by default.
+    static void setEnabled(bool);
+    static bool isEnabled();
+
+    /// Sets the maximum number of events to keep. When full, the oldest ones are overwritten.
+    /// Clears the current events. The default is 10000.
+    static void setCapacity(int);
+    static int capacity();
+
+    /// Returns the recorded events, oldest first
+    static std::vector<Event> events();
+    static void clear();
+
+    /// Returns the events in Chrome's trace event format
+    static QByteArray toChromeTraceJson();
+
+    /// Saves toChromeTraceJson() to @p filename. Returns true on success
+    static bool saveChromeTrace(const QString &filename);
+
+    static const char *stageName(Stage);
+
+    /// @internal Times its own lifetime as @p stage, if tracing is enabled and @p condition is true
+    class Scope
+    {
+    public:
+        explicit Scope(Stage stage, bool condition = true)
+            : m_stage(stage)
+            , m_startUs(s_enabled && condition ? now() : -1)
+        {
+        }
+
+        ~Scope()
+        {
+            if (m_startUs != -1)
+                record(m_stage, m_startUs, now() - m_startUs);
+        }
+
+    private:
+        KDDW_DELETE_COPY_CTOR(Scope)
+        const Stage m_stage;
+        const int64_t m_startUs;
+    };
+
+private:
+    static int64_t now();
+    static void record(Stage, int64_t startUs, int64_t durationUs);
+    static bool s_enabled;
+};
+
+}
+
+#endif
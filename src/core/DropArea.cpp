@@ -16,6 +16,7 @@
 #include "DockRegistry.h"
 #include "Platform.h"
 #include "core/Draggable_p.h"
+#include "core/DragTracer.h"
 #include "core/Logging_p.h"
 #include "core/Utils_p.h"
 #include "core/layouting/Item_p.h"
@@ -23,6 +24,7 @@
 #include "core/layouting/LayoutingSeparator_p.h"
 #include "core/WindowBeingDragged_p.h"
 #include "core/DelayedCall_p.h"
+#include "core/RectGrid_p.h"
 #include "core/Group.h"
 #include "core/FloatingWindow.h"
 #include "core/DockWidget_p.h"
@@ -74,6 +76,11 @@ public:
     Core::Group *const m_centralGroup = nullptr;
     Core::ItemBoxContainer *m_rootItem = nullptr;
     KDBindings::ScopedConnection m_visibleWidgetCountConnection;
+
+    /// The visible items, so groupContainingPos() doesn't need to visit every item on each mouse
+    /// move while dragging
+    RectGrid<Core::Item *> m_itemGrid;
+    uint64_t m_itemGridGeneration = 0;
 };
 }
 
@@ -126,17 +133,14 @@ DropArea::~DropArea()
 
 Core::Group::List DropArea::groups() const
 {
-    const Core::Item::List children = d->m_rootItem->items_recursive();
+    // Groups being deleted are still in the layout, so filter them out
+    const Core::Group::List &indexed = Layout::d_ptr()->itemIndex().groups;
     Core::Group::List groups;
+    groups.reserve(indexed.size());
 
-    for (const Core::Item *child : children) {
-        if (auto guest = child->guest()) {
-            if (!guest->freed()) {
-                if (auto group = Group::fromItem(child)) {
-                    groups.push_back(group);
-                }
-            }
-        }
+    for (Core::Group *group : indexed) {
+        if (!group->asLayoutingGuest()->freed())
+            groups.push_back(group);
     }
 
     return groups;
@@ -144,16 +148,25 @@ Core::Group::List DropArea::groups() const
 
 Core::Group *DropArea::groupContainingPos(Point globalPos) const
 {
-    const Core::Item::List &items = this->items();
-    for (Core::Item *item : items) {
-        auto group = Group::fromItem(item);
-        if (!group || !group->isVisible()) {
-            continue;
+    // Called on every mouse move while dragging, so use the grid instead of visiting every item
+    const uint64_t generation = asLayoutingHost()->generation();
+    if (generation != d->m_itemGridGeneration) {
+        std::vector<std::pair<Rect, Core::Item *>> entries;
+        for (Core::Item *item : items()) {
+            if (!item->isContainer() && item->isVisible())
+                entries.push_back({ item->mapToRoot(item->rect()), item });
         }
 
-        if (group->containsMouse(globalPos))
+        d->m_itemGrid.rebuild(std::move(entries), layoutSize());
+        d->m_itemGridGeneration = generation;
+    }
+
+    if (Core::Item *item = d->m_itemGrid.find(view()->mapFromGlobal(globalPos))) {
+        auto group = Group::fromItem(item);
+        if (group && group->isVisible())
             return group;
     }
+
     return nullptr;
 }
 
@@ -289,6 +302,7 @@ void DropArea::layoutParentContainerEqually(Core::DockWidget *dw)
 
 DropLocation DropArea::hover(WindowBeingDragged *draggedWindow, Point globalPos)
 {
+    DragTracer::Scope trace(DragTracer::Stage::DropAreaHover);
     if (Config::self().dropIndicatorsInhibited() || !validateAffinity(draggedWindow))
         return DropLocation_None;
 
@@ -321,6 +335,7 @@ static bool isOutterLocation(DropLocation location)
 
 bool DropArea::drop(WindowBeingDragged *droppedWindow, Point globalPos)
 {
+    DragTracer::Scope trace(DragTracer::Stage::Drop);
     // fv might be null, if on wayland
     Core::View *fv = droppedWindow->floatingWindowView();
 
@@ -330,11 +345,11 @@ bool DropArea::drop(WindowBeingDragged *droppedWindow, Point globalPos)
     }
 
     if (d->m_dropIndicatorOverlay->currentDropLocation() == DropLocation_None) {
-        KDDW_DEBUG("DropArea::drop: bailing out, drop location = none");
+        KDDW_DEBUG_CAT(DRAG, "DropArea::drop: bailing out, drop location = none");
         return false;
     }
 
-    KDDW_DEBUG("DropArea::drop: {}", ( void * )droppedWindow);
+    KDDW_DEBUG_CAT(DRAG, "DropArea::drop: {}", ( void * )droppedWindow);
 
     hover(droppedWindow, globalPos);
     auto droploc = d->m_dropIndicatorOverlay->currentDropLocation();
@@ -393,7 +408,7 @@ bool DropArea::drop(WindowBeingDragged *draggedWindow, Core::Group *acceptingGro
                       DropIndicatorOverlay::multisplitterLocationFor(droploc), nullptr);
         break;
     case DropLocation_Center:
-        KDDW_DEBUG("Tabbing window={} into group={}", ( void * )droppedWindow, ( void * )acceptingGroup);
+        KDDW_DEBUG_CAT(DRAG, "Tabbing window={} into group={}", ( void * )droppedWindow, ( void * )acceptingGroup);
 
         if (!validateAffinity(droppedWindow, acceptingGroup))
             return false;
@@ -436,7 +451,7 @@ bool DropArea::drop(WindowBeingDragged *draggedWindow, Core::Group *acceptingGro
 bool DropArea::drop(View *droppedWindow, KDDockWidgets::Location location,
                     Core::Group *relativeTo)
 {
-    KDDW_DEBUG("DropArea::drop");
+    KDDW_DEBUG_CAT(DRAG, "DropArea::drop");
 
     if (auto dock = droppedWindow->asDockWidgetController()) {
         if (!validateAffinity(dock))
@@ -634,7 +649,7 @@ void DropArea::addWidget(View *w, Location location, Core::Item *relativeToItem,
 void DropArea::addMultiSplitter(Core::DropArea *sourceMultiSplitter, Location location,
                                 Core::Group *relativeToGroup, const InitialOption &option)
 {
-    KDDW_DEBUG("DropArea::addMultiSplitter: {} {} {}", ( void * )sourceMultiSplitter, ( int )location, ( void * )relativeToGroup);
+    KDDW_DEBUG_CAT(LAYOUTING, "DropArea::addMultiSplitter: {} {} {}", ( void * )sourceMultiSplitter, ( int )location, ( void * )relativeToGroup);
     Item *relativeToItem = relativeToGroup ? relativeToGroup->layoutItem() : nullptr;
 
     addWidget(sourceMultiSplitter->view(), location, relativeToItem, option);
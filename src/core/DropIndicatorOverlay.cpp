@@ -22,6 +22,7 @@
 #include "core/WindowBeingDragged_p.h"
 
 #include "core/DragController_p.h"
+#include "core/DragTracer.h"
 #include "core/DockRegistry_p.h"
 
 using namespace KDDockWidgets;
@@ -228,6 +229,7 @@ void DropIndicatorOverlay::setCurrentDropLocation(DropLocation location)
 
 DropLocation DropIndicatorOverlay::hover(Point globalPos)
 {
+    DragTracer::Scope trace(DragTracer::Stage::IndicatorHover);
     const DropLocation loc = hover_impl(globalPos);
     setCurrentDropLocation(loc);
     return loc;
@@ -604,13 +604,19 @@ bool FloatingWindow::deserialize(const LayoutSaver::FloatingWindow &fw)
 }
 
 LayoutSaver::FloatingWindow FloatingWindow::serialize() const
+{
+    return serialize(/*includeLayout=*/true);
+}
+
+LayoutSaver::FloatingWindow FloatingWindow::serialize(bool includeLayout) const
 {
     LayoutSaver::FloatingWindow fw;
 
     fw.geometry = geometry();
     fw.normalGeometry = view()->normalGeometry();
     fw.isVisible = isVisible();
-    fw.multiSplitterLayout = dropArea()->serialize();
+    if (includeLayout)
+        fw.multiSplitterLayout = dropArea()->serialize();
     fw.screenIndex = Platform::instance()->screenNumberForView(view());
     fw.screenSize = Platform::instance()->screenSizeFor(view());
     fw.affinities = affinities();
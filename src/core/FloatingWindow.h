@@ -46,6 +46,9 @@ public:
     bool deserialize(const LayoutSaver::FloatingWindow &);
     LayoutSaver::FloatingWindow serialize() const;
 
+    /// Like serialize(), but allows to skip the layout, which is the expensive part.
+    LayoutSaver::FloatingWindow serialize(bool includeLayout) const;
+
     // Draggable:
     std::unique_ptr<WindowBeingDragged> makeWindow() override;
     Core::DockWidget *singleDockWidget() const override final;
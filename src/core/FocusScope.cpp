@@ -26,6 +26,7 @@
 #include "core/Logging_p.h"
 #include "core/ViewGuard.h"
 #include "View.h"
+#include "ObjectGuard_p.h"
 #include "core/views/DockWidgetViewInterface.h"
 
 using namespace KDDockWidgets;
@@ -37,11 +38,12 @@ public:
     Private(FocusScope *qq, View *thisView)
         : q(qq)
         , m_thisView(thisView)
+        , m_handle(thisView ? thisView->handle() : nullptr)
     {
-        auto plat = Platform::instance();
-        m_connection = plat->d->focusedViewChanged.connect(&Private::onFocusedViewChanged, this);
-
-        onFocusedViewChanged(plat->focusedView());
+        // Focus changes are dispatched by DockRegistry, which walks the focused view's ancestors
+        // once for all scopes. Here we only compute the initial state.
+        auto view = Platform::instance()->focusedView();
+        onFocusedViewChanged(view, isInFocusScope(view));
 
         // NOLINTNEXTLINE(cppcoreguidelines-prefer-member-initializer)
         m_inCtor = false;
@@ -54,35 +56,39 @@ public:
             && m_lastFocusedInScope->is(ViewType::Stack);
     }
 
-    ~Private();
-
     void setIsFocused(bool);
-    void onFocusedViewChanged(std::shared_ptr<View> view);
+    void onFocusedViewChanged(const std::shared_ptr<View> &view, bool isInScope);
     bool isInFocusScope(std::shared_ptr<View> view) const;
 
     FocusScope *const q;
     ViewGuard m_thisView;
+    const Core::HANDLE m_handle;
+    ObjectGuard<DockRegistry> m_registry;
     bool m_isFocused = false;
     bool m_inCtor = true;
     std::shared_ptr<View> m_lastFocusedInScope;
-    KDBindings::ConnectionHandle m_connection;
 };
 
-FocusScope::Private::~Private()
-{
-    m_connection.disconnect();
-}
-
 FocusScope::FocusScope(View *thisView)
     : d(new Private(this, thisView))
 {
+    d->m_registry = DockRegistry::self();
+    d->m_registry->registerFocusScope(this, d->m_handle);
 }
 
 FocusScope::~FocusScope()
 {
+    // Don't use DockRegistry::self(), as it would be recreated if already deleted
+    if (d->m_registry)
+        d->m_registry->unregisterFocusScope(this, d->m_handle);
     delete d;
 }
 
+void FocusScope::onFocusedViewChanged(const std::shared_ptr<View> &view, bool isInScope)
+{
+    d->onFocusedViewChanged(view, isInScope);
+}
+
 bool FocusScope::isFocused() const
 {
     return d->m_isFocused;
@@ -104,23 +110,23 @@ void FocusScope::focus(Qt::FocusReason reason)
                 if (auto dwView = dynamic_cast<Core::DockWidgetViewInterface *>(dw->view())) {
                     if (auto candidate = dwView->focusCandidate()) {
                         if (candidate->focusPolicy() != Qt::NoFocus) {
-                            KDDW_DEBUG("FocusScope::focus: Setting focus on candidate!");
+                            KDDW_DEBUG_CAT(FOCUS, "FocusScope::focus: Setting focus on candidate!");
                             candidate->setFocus(reason);
                         } else {
-                            KDDW_DEBUG("FocusScope::focus: Candidate has no focus policy");
+                            KDDW_DEBUG_CAT(FOCUS, "FocusScope::focus: Candidate has no focus policy");
                         }
                     } else {
-                        KDDW_DEBUG("FocusScope::focus: Candidate not found");
+                        KDDW_DEBUG_CAT(FOCUS, "FocusScope::focus: Candidate not found");
                     }
                 } else {
-                    KDDW_DEBUG("FocusScope::focus: Dw doesn't have view");
+                    KDDW_DEBUG_CAT(FOCUS, "FocusScope::focus: Dw doesn't have view");
                 }
             } else {
-                KDDW_DEBUG("FocusScope::focus: Group doesn't have current DW");
+                KDDW_DEBUG_CAT(FOCUS, "FocusScope::focus: Group doesn't have current DW");
             }
         } else {
             // Not a use case right now
-            KDDW_DEBUG("FocusScope::focus: No group found");
+            KDDW_DEBUG_CAT(FOCUS, "FocusScope::focus: No group found");
             d->m_thisView->setFocus(reason);
         }
     }
@@ -136,14 +142,13 @@ void FocusScope::Private::setIsFocused(bool is)
     }
 }
 
-void FocusScope::Private::onFocusedViewChanged(std::shared_ptr<View> view)
+void FocusScope::Private::onFocusedViewChanged(const std::shared_ptr<View> &view, bool is)
 {
     if (!view || view->isNull()) {
         setIsFocused(false);
         return;
     }
 
-    const bool is = isInFocusScope(view);
     const bool focusViewChanged = !m_lastFocusedInScope || m_lastFocusedInScope->isNull()
         || !m_lastFocusedInScope->equals(view);
     if (is && focusViewChanged && !view->is(ViewType::TitleBar)) {
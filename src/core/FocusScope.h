@@ -22,6 +22,12 @@
 #include "kddockwidgets/docks_export.h"
 #include "kddockwidgets/KDDockWidgets.h"
 
+#include <memory>
+
+namespace KDDockWidgets {
+class DockRegistry;
+}
+
 namespace KDDockWidgets::Core {
 
 class View;
@@ -51,6 +57,12 @@ protected:
     virtual void focusedWidgetChangedCallback() = 0;
 
 private:
+    friend class KDDockWidgets::DockRegistry;
+
+    /// Called by DockRegistry when the focused view changes, but only if this scope's focus
+    /// changed or if @p view is inside this scope (@p isInScope)
+    void onFocusedViewChanged(const std::shared_ptr<View> &view, bool isInScope);
+
     class Private;
     Private *const d;
 };
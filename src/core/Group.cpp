@@ -78,6 +78,15 @@ static FrameOptions actualOptions(FrameOptions options)
     return options;
 }
 
+/// Our tabs are serialized along with the layout, so tell it they changed
+static void setLayoutChanged(Group *group)
+{
+    if (Item *item = group->layoutItem()) {
+        if (LayoutingHost *host = item->host())
+            host->setLayoutChanged();
+    }
+}
+
 static StackOptions tabWidgetOptions(FrameOptions options)
 {
     if (options & FrameOption_NonDockable) {
@@ -103,6 +112,7 @@ Group::Group(View *parent, FrameOptions options, int userType)
 
     m_tabBar->dptr()->currentDockWidgetChanged.connect([this] {
         updateTitleAndIcon();
+        setLayoutChanged(this);
     });
 
     setLayout(parent ? parent->asLayout() : nullptr);
@@ -428,6 +438,7 @@ void Group::onDockWidgetCountChanged()
         }
     }
 
+    setLayoutChanged(this);
     d->numDockWidgetsChanged.emit();
 }
 
@@ -1040,11 +1051,14 @@ LayoutingGuest *Group::asLayoutingGuest() const
     return d;
 }
 
+int Group::Private::s_numCreated = 0;
+
 Group::Private::Private(Group *qq, int userType, FrameOptions options)
     : q(qq)
     , m_userType(userType)
     , m_options(options)
 {
+    ++s_numCreated;
     m_parentViewChangedConnection = q->Controller::dptr()->parentViewChanged.connect([this] {
         hostChanged.emit(host());
     });
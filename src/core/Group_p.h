@@ -39,6 +39,9 @@ public:
 
     ObjectGuard<Core::Item> m_layoutItem;
 
+    /// Number of groups created so far. See LayoutSaver::RestoreProfile
+    static int s_numCreated;
+
     KDBindings::Signal<> numDockWidgetsChanged;
     KDBindings::Signal<> hasTabsVisibleChanged;
     KDBindings::Signal<> isInMainWindowChanged;
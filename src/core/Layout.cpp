@@ -20,6 +20,7 @@
 #include "View_p.h"
 #include "Logging_p.h"
 #include "ScopedValueRollback_p.h"
+#include "WidgetResizeHandler_p.h"
 #include "DropArea.h"
 #include "DockWidget_p.h"
 #include "Group.h"
@@ -102,6 +103,7 @@ void Layout::setRootItem(Core::ItemContainer *root)
 {
     delete d->m_rootItem;
     d->m_rootItem = root;
+    d->invalidateItemIndex();
     d->m_rootItem->numVisibleItemsChanged.connect(
         [this](int count) { d->visibleWidgetCountChanged.emit(count); });
 
@@ -140,7 +142,12 @@ void Layout::clearLayout()
 
 bool Layout::checkSanity() const
 {
-    return d->m_rootItem->checkSanity();
+    if (!d->m_rootItem->checkSanity()) {
+        Core::Item::reportSanityViolation();
+        return false;
+    }
+
+    return true;
 }
 
 void Layout::dumpLayout() const
@@ -185,7 +192,11 @@ void Layout::unrefOldPlaceholders(const Core::Group::List &groupsBeingAdded) con
 void Layout::setLayoutSize(Size size)
 {
     if (size != layoutSize()) {
-        d->m_rootItem->setSize_recursive(size);
+        {
+            // Guests are only moved once, instead of once per nesting level
+            Core::LayoutTransaction transaction(asLayoutingHost());
+            d->m_rootItem->setSize_recursive(size);
+        }
         if (!d->m_inResizeEvent && !LayoutSaver::restoreInProgress())
             view()->resize(size);
     }
@@ -193,7 +204,7 @@ void Layout::setLayoutSize(Size size)
 
 Core::Item::List Layout::items() const
 {
-    return d->m_rootItem->items_recursive();
+    return d->itemIndex().items;
 }
 
 bool Layout::containsItem(const Core::Item *item) const
@@ -226,7 +237,9 @@ Core::Item *Layout::itemForGroup(const Core::Group *group) const
     if (!group)
         return nullptr;
 
-    return d->m_rootItem->itemForView(group->asLayoutingGuest());
+    const auto &itemsByGuest = d->itemIndex().itemsByGuest;
+    auto it = itemsByGuest.find(group->asLayoutingGuest());
+    return it == itemsByGuest.cend() ? nullptr : it->second;
 }
 
 Core::DockWidget::List Layout::dockWidgets() const
@@ -252,18 +265,7 @@ Core::Group::List Layout::groupsFrom(View *groupOrMultiSplitter) const
 
 Core::Group::List Layout::groups() const
 {
-    const Core::Item::List items = d->m_rootItem->items_recursive();
-
-    Core::Group::List result;
-    result.reserve(items.size());
-
-    for (Core::Item *item : items) {
-        if (auto group = Group::fromItem(item)) {
-            result.push_back(group);
-        }
-    }
-
-    return result;
+    return d->itemIndex().groups;
 }
 
 void Layout::removeItem(Core::Item *item)
@@ -321,7 +323,7 @@ LayoutSaver::MultiSplitter Layout::serialize() const
 {
     LayoutSaver::MultiSplitter l;
     d->m_rootItem->to_json(l.layout);
-    const Core::Item::List items = d->m_rootItem->items_recursive();
+    const Core::Item::List &items = d->itemIndex().items;
     l.groups.reserve(size_t(items.size()));
     for (Core::Item *item : items) {
         if (!item->isContainer()) {
@@ -374,6 +376,11 @@ Layout::Private *Layout::d_ptr()
     return d;
 }
 
+const Layout::Private *Layout::d_ptr() const
+{
+    return d;
+}
+
 bool Layout::Private::supportsHonouringLayoutMinSize() const
 {
     if (auto window = q->view()->window()) {
@@ -391,6 +398,33 @@ Layout::Private::Private(Layout *qq)
 
 Layout::Private::~Private() = default;
 
+const Layout::Private::ItemIndex &Layout::Private::itemIndex() const
+{
+    if (m_itemIndex.structureGeneration == structureGeneration() || !m_rootItem)
+        return m_itemIndex;
+
+    m_itemIndex.items = m_rootItem->items_recursive();
+    m_itemIndex.groups.clear();
+    m_itemIndex.itemsByGuest.clear();
+    m_itemIndex.groups.reserve(m_itemIndex.items.size());
+    m_itemIndex.itemsByGuest.reserve(size_t(m_itemIndex.items.size()));
+
+    for (Core::Item *item : std::as_const(m_itemIndex.items)) {
+        if (auto guest = item->guest())
+            m_itemIndex.itemsByGuest.emplace(guest, item);
+        if (auto group = Group::fromItem(item))
+            m_itemIndex.groups.push_back(group);
+    }
+
+    m_itemIndex.structureGeneration = structureGeneration();
+    return m_itemIndex;
+}
+
+void Layout::Private::invalidateItemIndex()
+{
+    m_itemIndex = {};
+}
+
 
 /** static */
 Layout *Layout::fromLayoutingHost(LayoutingHost *host)
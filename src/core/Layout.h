@@ -200,6 +200,7 @@ public:
 
     class Private;
     Layout::Private *d_ptr();
+    const Layout::Private *d_ptr() const;
 
 protected:
     void setRootItem(Core::ItemContainer *root);
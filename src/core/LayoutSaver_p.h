@@ -18,6 +18,7 @@
 #include "core/Window_p.h"
 #include "nlohmann_helpers_p.h"
 
+#include <iosfwd>
 #include <memory>
 #include <unordered_map>
 #include <map>
@@ -116,19 +117,9 @@ struct DOCKS_EXPORT LayoutSaver::DockWidget
     /// RestoreOption_RelativeToMainWindow.
     void scaleSizes(const ScalingInfo &scalingInfo);
 
-    static Ptr dockWidgetForName(const QString &name)
-    {
-        auto it = s_dockWidgets.find(name);
-        auto dw = it == s_dockWidgets.cend() ? nullptr : it->second;
-        if (dw)
-            return dw;
-
-        dw = Ptr(new LayoutSaver::DockWidget);
-        s_dockWidgets[name] = dw;
-        dw->uniqueName = name;
-
-        return dw;
-    }
+    /// Returns the instance for @p name, creating it if needed. While a layout is being prepared,
+    /// instances are shared only within that layout, otherwise they're shared via s_dockWidgets
+    static Ptr dockWidgetForName(const QString &name);
 
     bool skipsRestore() const;
 
@@ -262,33 +253,30 @@ struct LayoutSaver::ScreenInfo
 struct DOCKS_EXPORT LayoutSaver::Layout
 {
 public:
-    Layout()
-    {
-        s_currentLayoutBeingRestored = this;
-
-        const auto screens = Core::Platform::instance()->screens();
-        const int numScreens = screens.size();
-        screenInfo.reserve(numScreens);
-        for (int i = 0; i < numScreens; ++i) {
-            ScreenInfo info;
-            info.index = i;
-            info.geometry = screens[i]->geometry();
-            info.name = screens[i]->name();
-            info.devicePixelRatio = screens[i]->devicePixelRatio();
-            screenInfo.push_back(info);
-        }
-    }
-
-    ~Layout()
-    {
-        s_currentLayoutBeingRestored = nullptr;
-    }
+    Layout() = default;
 
     bool isValid() const;
 
+    /// Fills screenInfo with the current screens
+    void saveScreenInfo();
+
+    /// Serializes to JSON. It's written incrementally, there's no intermediate DOM.
     QByteArray toJson() const;
+    bool toJson(std::ostream &) const;
+
+    /// Parses JSON. Each window is parsed into its own DOM, there's none for the whole layout.
     bool fromJson(const QByteArray &jsonData);
 
+    QByteArray toCbor() const;
+    bool fromCbor(const QByteArray &cborData);
+
+    /// Calls fromJson() or fromCbor(), depending on what @p data contains
+    bool fromSerialized(const QByteArray &data);
+
+    /// Returns whether @p data, JSON or CBOR, has the structure of a layout.
+    /// It's cheap, nothing is parsed into a Layout. See LayoutSchemaValidator.
+    static bool isWellFormed(const QByteArray &data, std::string *error = nullptr);
+
     /// Iterates through the layout and patches all absolute sizes. See
     /// RestoreOption_RelativeToMainWindow.
     void scaleSizes(KDDockWidgets::InternalRestoreOptions);
@@ -310,10 +298,16 @@ public:
     LayoutSaver::DockWidget::List allDockWidgets;
     ScreenInfo::List screenInfo;
 
+    /// Set by restoreLayout(), as a prepared layout can't be restored twice
+    bool wasRestored = false;
+
 private:
     KDDW_DELETE_COPY_CTOR(Layout)
 };
 
+/// Converts to a DOM. Layout::toJson() streams the same thing, byte for byte, without one.
+DOCKS_EXPORT_FOR_UNIT_TESTS void to_json(nlohmann::json &, const LayoutSaver::Layout &);
+
 class DOCKS_EXPORT LayoutSaver::Private
 {
 public:
@@ -325,9 +319,17 @@ public:
     };
 
     explicit Private(RestoreOptions options);
+    ~Private();
 
     static void restorePendingPositions(Core::DockWidget *);
 
+    /// Fills @p layout with the current state. Returns false if the current state isn't sane.
+    bool serializeLayout(LayoutSaver::Layout &layout) const;
+
+    /// Implementation of LayoutSaver::prepareLayout(). Fills @p profile, if not null
+    static std::shared_ptr<LayoutSaver::Layout> prepareLayout(const QByteArray &data,
+                                                              LayoutSaver::RestoreProfile *profile);
+
     bool matchesAffinity(const Vector<QString> &affinities) const;
     void floatWidgetsWhichSkipRestore(const Vector<QString> &mainWindowNames);
     void floatUnknownWidgets(const LayoutSaver::Layout &layout);
@@ -340,6 +342,13 @@ public:
     DockRegistry *const m_dockRegistry;
     InternalRestoreOptions m_restoreOptions = {};
     Vector<QString> m_affinityNames;
+    LayoutSaverFormat m_format = LayoutSaverFormat::Json;
+    bool m_restoreProfilingEnabled = false;
+    LayoutSaver::RestoreProfile m_lastRestoreProfile;
+
+    /// What was serialized by the last serializeLayoutDelta() call
+    struct DeltaState;
+    std::unique_ptr<DeltaState> m_deltaState;
 
     /// If a layout is restored but the dock widget doesn't exist, we store its last position here
     /// so when we create the dock widget we can finally restore
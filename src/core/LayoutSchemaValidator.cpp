@@ -0,0 +1,587 @@
+/*
+  This file is part of KDDockWidgets.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include "LayoutSchemaValidator_p.h"
+
+#include <cstdint>
+#include <vector>
+
+using namespace KDDockWidgets;
+
+namespace {
+
+enum Type : uint8_t {
+    Null = 1,
+    Boolean = 2,
+    Integer = 4,
+    Number = 8, // Integers are numbers too
+    String = 16,
+    Array = 32,
+    Object = 64,
+};
+
+struct Node;
+
+struct Property
+{
+    const char *name;
+    const Node *node;
+    bool required;
+};
+
+/// A schema, describing a JSON value
+struct Node
+{
+    uint8_t types = 0;
+
+    /// For objects
+    const Property *properties = nullptr;
+    int numProperties = 0;
+    uint32_t requiredMask = 0;
+    const Node *additionalProperties = nullptr;
+
+    /// For arrays, either all elements have the same schema or it's a tuple of numPrefixItems
+    const Node *items = nullptr;
+    const Node *const *prefixItems = nullptr;
+    int numPrefixItems = 0;
+
+    /// The name in layout_schema.json's "definitions", if it has one
+    const char *definition = nullptr;
+};
+
+constexpr Node scalar(uint8_t types, const char *definition = nullptr)
+{
+    Node node;
+    node.types = types;
+    node.definition = definition;
+    return node;
+}
+
+template<int N>
+constexpr Node object(const Property (&properties)[N], const char *definition = nullptr)
+{
+    static_assert(N <= 32, "The required members are a 32 bit mask");
+    Node node;
+    node.types = Object;
+    node.properties = properties;
+    node.numProperties = N;
+    for (int i = 0; i < N; ++i) {
+        if (properties[i].required)
+            node.requiredMask |= 1u << i;
+    }
+    node.definition = definition;
+    return node;
+}
+
+/// An object whose members all have the same schema, with any name
+constexpr Node map(const Node *values, uint8_t extraTypes = 0)
+{
+    Node node;
+    node.types = Object | extraTypes;
+    node.additionalProperties = values;
+    return node;
+}
+
+constexpr Node array(const Node *items, uint8_t extraTypes = 0)
+{
+    Node node;
+    node.types = Array | extraTypes;
+    node.items = items;
+    return node;
+}
+
+template<int N>
+constexpr Node tuple(const Node *const (&items)[N], const char *definition)
+{
+    Node node;
+    node.types = Array;
+    node.prefixItems = items;
+    node.numPrefixItems = N;
+    node.definition = definition;
+    return node;
+}
+
+// The rules. Lists written by LayoutSaver can be null, that's how nlohmann writes empty ones.
+
+const Node s_integer = scalar(Integer);
+const Node s_number = scalar(Number);
+const Node s_boolean = scalar(Boolean);
+const Node s_string = scalar(String);
+const Node s_stringList = array(&s_string, Null);
+
+const Property s_geometryProperties[] = {
+    { "height", &s_integer, true },
+    { "width", &s_integer, true },
+    { "x", &s_integer, true },
+    { "y", &s_integer, true },
+};
+const Node s_geometry = object(s_geometryProperties, "geometry");
+
+const Property s_sizeProperties[] = {
+    { "height", &s_integer, true },
+    { "width", &s_integer, true },
+};
+const Node s_size = object(s_sizeProperties, "size");
+
+const Node s_sideBarLocation = scalar(Integer, "SideBarLocation");
+const Node *const s_lastOverlayedGeometryItems[] = { &s_sideBarLocation, &s_geometry };
+const Node s_lastOverlayedGeometry = tuple(s_lastOverlayedGeometryItems, "lastOverlayedGeometry");
+const Node s_lastOverlayedGeometries = array(&s_lastOverlayedGeometry, Null);
+
+const Property s_placeholderProperties[] = {
+    { "indexOfFloatingWindow", &s_integer, false },
+    { "isFloatingWindow", &s_boolean, true },
+    { "itemIndex", &s_integer, true },
+    { "mainWindowUniqueName", &s_string, false },
+};
+const Node s_placeholder = object(s_placeholderProperties, "placeholder");
+const Node s_placeholders = array(&s_placeholder, Null);
+
+const Property s_screenProperties[] = {
+    { "devicePixelRatio", &s_number, true },
+    { "geometry", &s_geometry, true },
+    { "index", &s_integer, true },
+    { "name", &s_string, true },
+};
+const Node s_screen = object(s_screenProperties, "screen");
+
+const Property s_sizingInfoProperties[] = {
+    { "geometry", &s_geometry, true },
+    { "isBeingInserted", &s_boolean, false },
+    { "maxSizeHint", &s_size, false },
+    { "minSize", &s_size, true },
+    { "percentageWithinParent", &s_number, false },
+};
+const Node s_sizingInfo = object(s_sizingInfoProperties);
+
+extern const Node s_layoutItem;
+const Node s_layoutItems = array(&s_layoutItem, Null);
+
+const Property s_layoutItemProperties[] = {
+    { "children", &s_layoutItems, false },
+    { "guestId", &s_string, false },
+    { "isContainer", &s_boolean, true },
+    { "isVisible", &s_boolean, true },
+    { "objectName", &s_string, false },
+    { "orientation", &s_integer, false },
+    { "sizingInfo", &s_sizingInfo, true },
+};
+const Node s_layoutItem = object(s_layoutItemProperties, "layoutItem");
+
+const Property s_positionProperties[] = {
+    { "lastFloatingGeometry", &s_geometry, true },
+    { "lastOverlayedGeometries", &s_lastOverlayedGeometries, false },
+    { "placeholders", &s_placeholders, true },
+    { "tabIndex", &s_integer, true },
+    { "wasFloating", &s_boolean, true },
+};
+const Node s_position = object(s_positionProperties);
+
+const Property s_dockWidgetProperties[] = {
+    { "affinities", &s_stringList, false },
+    { "lastCloseReason", &s_integer, false },
+    { "lastPosition", &s_position, true },
+    { "uniqueName", &s_string, true },
+};
+const Node s_dockWidget = object(s_dockWidgetProperties, "dockwidget");
+
+const Property s_groupProperties[] = {
+    { "currentTabIndex", &s_integer, true },
+    { "dockWidgets", &s_stringList, true },
+    { "geometry", &s_geometry, true },
+    { "id", &s_string, true },
+    { "isNull", &s_boolean, true },
+    { "mainWindowUniqueName", &s_string, false },
+    { "objectName", &s_string, true },
+    { "options", &s_integer, true },
+};
+const Node s_group = object(s_groupProperties, "group");
+const Node s_groups = map(&s_group, Null);
+
+const Property s_multiSplitterProperties[] = {
+    { "frames", &s_groups, true },
+    { "layout", &s_layoutItem, true },
+};
+const Node s_multiSplitter = object(s_multiSplitterProperties, "multiSplitterLayout");
+
+const Property s_mainWindowProperties[] = {
+    { "affinities", &s_stringList, false },
+    { "affinityName", &s_string, false },
+    { "geometry", &s_geometry, true },
+    { "isVisible", &s_boolean, true },
+    { "multiSplitterLayout", &s_multiSplitter, true },
+    { "normalGeometry", &s_geometry, false },
+    { "options", &s_integer, true },
+    { "screenIndex", &s_integer, true },
+    { "screenSize", &s_size, true },
+    { "uniqueName", &s_string, true },
+    { "windowState", &s_integer, false },
+};
+const Node s_mainWindow = object(s_mainWindowProperties, "mainWindow");
+
+const Property s_floatingWindowProperties[] = {
+    { "affinities", &s_stringList, false },
+    { "affinityName", &s_string, false },
+    { "flags", &s_integer, false },
+    { "geometry", &s_geometry, true },
+    { "isVisible", &s_boolean, true },
+    { "multiSplitterLayout", &s_multiSplitter, true },
+    { "normalGeometry", &s_geometry, false },
+    { "parentIndex", &s_integer, true },
+    { "screenIndex", &s_integer, true },
+    { "screenSize", &s_size, true },
+    { "windowState", &s_integer, false },
+};
+const Node s_floatingWindow = object(s_floatingWindowProperties, "floatingWindow");
+
+const Node s_dockWidgets = array(&s_dockWidget, Null);
+const Node s_floatingWindows = array(&s_floatingWindow);
+const Node s_mainWindows = array(&s_mainWindow);
+const Node s_screens = array(&s_screen);
+
+const Property s_layoutProperties[] = {
+    { "allDockWidgets", &s_dockWidgets, true },
+    { "closedDockWidgets", &s_stringList, true },
+    { "floatingWindows", &s_floatingWindows, true },
+    { "mainWindows", &s_mainWindows, true },
+    { "screenInfo", &s_screens, true },
+    { "serializationVersion", &s_integer, true },
+};
+const Node s_layout = object(s_layoutProperties);
+
+const Node *const s_definitions[] = {
+    &s_geometry, &s_size, &s_sideBarLocation, &s_lastOverlayedGeometry, &s_placeholder,
+    &s_screen, &s_layoutItem, &s_dockWidget, &s_group, &s_mainWindow,
+    &s_floatingWindow, &s_multiSplitter
+};
+
+const char *typeName(uint8_t type)
+{
+    switch (type) {
+    case Null:
+        return "null";
+    case Boolean:
+        return "boolean";
+    case Integer:
+        return "integer";
+    case Number:
+        return "number";
+    case String:
+        return "string";
+    case Array:
+        return "array";
+    case Object:
+        return "object";
+    }
+
+    return "binary";
+}
+
+std::string typeNames(uint8_t types)
+{
+    std::string result;
+    for (int type = Null; type <= Object; type <<= 1) {
+        if (types & type) {
+            if (!result.empty())
+                result += " or ";
+            result += typeName(uint8_t(type));
+        }
+    }
+
+    return result;
+}
+
+nlohmann::json toJsonSchema(const Node &node, bool expandDefinition = false)
+{
+    if (node.definition && !expandDefinition)
+        return { { "$ref", std::string("#/definitions/") + node.definition } };
+
+    nlohmann::json json;
+    nlohmann::json types = nlohmann::json::array();
+    for (int type = Null; type <= Object; type <<= 1) {
+        if (node.types & type)
+            types.push_back(typeName(uint8_t(type)));
+    }
+    json["type"] = types.size() == 1 ? types.front() : types;
+
+    if (node.numProperties > 0) {
+        nlohmann::json required = nlohmann::json::array();
+        for (int i = 0; i < node.numProperties; ++i) {
+            const Property &property = node.properties[i];
+            json["properties"][property.name] = toJsonSchema(*property.node);
+            if (property.required)
+                required.push_back(property.name);
+        }
+        json["required"] = required;
+    }
+
+    if (node.additionalProperties)
+        json["additionalProperties"] = toJsonSchema(*node.additionalProperties);
+
+    if (node.items)
+        json["items"] = toJsonSchema(*node.items);
+
+    if (node.numPrefixItems > 0) {
+        for (int i = 0; i < node.numPrefixItems; ++i)
+            json["prefixItems"].push_back(toJsonSchema(*node.prefixItems[i]));
+        json["minItems"] = node.numPrefixItems;
+        json["maxItems"] = node.numPrefixItems;
+    }
+
+    return json;
+}
+
+/// Receives nlohmann's SAX events and checks them against the rules above
+class SchemaSaxHandler
+{
+public:
+    using json = nlohmann::json;
+
+    SchemaSaxHandler()
+    {
+        m_stack.reserve(16);
+    }
+
+    bool null()
+    {
+        return value(Null);
+    }
+
+    bool boolean(bool)
+    {
+        return value(Boolean);
+    }
+
+    bool number_integer(json::number_integer_t)
+    {
+        return value(Integer);
+    }
+
+    bool number_unsigned(json::number_unsigned_t)
+    {
+        return value(Integer);
+    }
+
+    bool number_float(json::number_float_t, const json::string_t &)
+    {
+        return value(Number);
+    }
+
+    bool string(json::string_t &)
+    {
+        return value(String);
+    }
+
+    bool binary(json::binary_t &)
+    {
+        return value(0);
+    }
+
+    bool start_object(std::size_t)
+    {
+        return startContainer(Object);
+    }
+
+    bool end_object()
+    {
+        return endContainer();
+    }
+
+    bool start_array(std::size_t)
+    {
+        return startContainer(Array);
+    }
+
+    bool end_array()
+    {
+        return endContainer();
+    }
+
+    bool key(json::string_t &name)
+    {
+        Frame &frame = m_stack.back();
+        frame.memberNode = nullptr;
+        frame.memberName = nullptr;
+        if (!frame.node)
+            return true;
+
+        for (int i = 0; i < frame.node->numProperties; ++i) {
+            const Property &property = frame.node->properties[i];
+            if (name == property.name) {
+                frame.memberNode = property.node;
+                frame.memberName = property.name;
+                frame.membersSeen |= 1u << i;
+                return true;
+            }
+        }
+
+        if (frame.node->additionalProperties) {
+            frame.memberNode = frame.node->additionalProperties;
+            frame.dynamicMemberName = name;
+        }
+
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string &, const json::exception &e)
+    {
+        m_error = e.what();
+        return false;
+    }
+
+    const std::string &error() const
+    {
+        return m_error;
+    }
+
+private:
+    struct Frame
+    {
+        Frame(const Node *node_, bool isArray_)
+            : node(node_)
+            , isArray(isArray_)
+        {
+        }
+
+        /// Null if the container isn't being checked, as it's an unknown member
+        const Node *node;
+        bool isArray;
+        int numElements = 0;
+        uint32_t membersSeen = 0;
+
+        /// The member being visited, for objects
+        const Node *memberNode = nullptr;
+        const char *memberName = nullptr;
+        std::string dynamicMemberName;
+    };
+
+    /// Returns the schema for the value being started, or null if it isn't checked
+    const Node *nextNode()
+    {
+        if (m_stack.empty())
+            return &s_layout;
+
+        Frame &frame = m_stack.back();
+        if (!frame.node)
+            return nullptr;
+
+        if (!frame.isArray)
+            return frame.memberNode;
+
+        const int index = frame.numElements++;
+        if (frame.node->numPrefixItems == 0)
+            return frame.node->items;
+
+        return index < frame.node->numPrefixItems ? frame.node->prefixItems[index] : nullptr;
+    }
+
+    bool checkType(const Node *node, uint8_t type)
+    {
+        if (!node || (node->types & type) || (type == Integer && (node->types & Number)))
+            return true;
+
+        return fail(m_stack.size(),
+                    std::string("Expected ") + typeNames(node->types) + ", got " + typeName(type));
+    }
+
+    bool value(uint8_t type)
+    {
+        return checkType(nextNode(), type);
+    }
+
+    bool startContainer(uint8_t type)
+    {
+        const Node *node = nextNode();
+        if (!checkType(node, type))
+            return false;
+
+        if (m_stack.size() >= size_t(LayoutSchemaValidator::maxDepth))
+            return fail(m_stack.size(), "Too deeply nested");
+
+        m_stack.emplace_back(node, type == Array);
+        return true;
+    }
+
+    bool endContainer()
+    {
+        const Frame &frame = m_stack.back();
+        if (const Node *node = frame.node) {
+            if (node->numPrefixItems > 0 && frame.numElements != node->numPrefixItems) {
+                return fail(m_stack.size() - 1,
+                            "Expected " + std::to_string(node->numPrefixItems) + " elements, got "
+                                + std::to_string(frame.numElements));
+            }
+
+            const uint32_t missing = node->requiredMask & ~frame.membersSeen;
+            if (missing) {
+                for (int i = 0; i < node->numProperties; ++i) {
+                    if (missing & (1u << i))
+                        return fail(m_stack.size() - 1,
+                                    std::string("Missing required member \"") + node->properties[i].name + "\"");
+                }
+            }
+        }
+
+        m_stack.pop_back();
+        return true;
+    }
+
+    /// Sets the error, with the path to the value being visited at depth @p depth
+    bool fail(size_t depth, const std::string &message)
+    {
+        std::string path;
+        for (size_t i = 0; i < depth; ++i) {
+            const Frame &frame = m_stack[i];
+            if (frame.isArray) {
+                path += '[' + std::to_string(frame.numElements - 1) + ']';
+            } else {
+                if (!path.empty())
+                    path += '.';
+                path += frame.memberName ? frame.memberName : frame.dynamicMemberName.c_str();
+            }
+        }
+
+        m_error = message + " at " + (path.empty() ? "the top-level" : path);
+        return false;
+    }
+
+    std::vector<Frame> m_stack;
+    std::string m_error;
+};
+
+}
+
+bool LayoutSchemaValidator::validate(const char *begin, const char *end,
+                                     nlohmann::json::input_format_t format, std::string *error)
+{
+    SchemaSaxHandler handler;
+    bool ok = false;
+    try {
+        ok = nlohmann::json::sax_parse(begin, end, &handler, format);
+    } catch (const std::exception &e) {
+        if (error)
+            *error = e.what();
+        return false;
+    }
+
+    if (!ok && error)
+        *error = handler.error();
+
+    return ok;
+}
+
+nlohmann::json LayoutSchemaValidator::schema()
+{
+    nlohmann::json json = toJsonSchema(s_layout);
+    for (const Node *node : s_definitions)
+        json["definitions"][node->definition] = toJsonSchema(*node, /*expandDefinition=*/true);
+
+    return json;
+}
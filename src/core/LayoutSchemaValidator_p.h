@@ -0,0 +1,48 @@
+/*
+  This file is part of KDDockWidgets.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#pragma once
+
+#include "kddockwidgets/docks_export.h"
+
+#include <nlohmann/json.hpp>
+
+#include <string>
+
+namespace KDDockWidgets {
+
+/**
+ * @brief Checks that serialized layout data has the structure LayoutSaver expects
+ *
+ * It's a single pass over nlohmann's SAX events, done before the data is parsed into a
+ * LayoutSaver::Layout, so corrupted files are rejected before any DOM or layout object is created.
+ *
+ * The members LayoutSaver knows about must have the expected types and the required ones must be
+ * present. Unknown members are ignored. Values aren't checked, for example an unsupported
+ * serialization version is still left for LayoutSaver::Layout::isValid() to report.
+ *
+ * The rules follow layout_schema.json. A test compares them against it, see schema().
+ */
+class DOCKS_EXPORT LayoutSchemaValidator
+{
+public:
+    /// @brief Validates the JSON or CBOR in [@p begin, @p end)
+    /// If it's not valid, @p error, if not null, is set to what's wrong, and where.
+    static bool validate(const char *begin, const char *end, nlohmann::json::input_format_t format,
+                         std::string *error = nullptr);
+
+    /// @brief Returns the rules as a JSON schema, in the same form as layout_schema.json
+    static nlohmann::json schema();
+
+    /// @brief Nesting deeper than this is rejected. Restoring the layout items is recursive.
+    static constexpr int maxDepth = 128;
+};
+
+}
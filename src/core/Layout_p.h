@@ -15,6 +15,13 @@
 #include "layouting/LayoutingHost_p.h"
 #include "kdbindings/signal.h"
 
+#include <memory>
+#include <unordered_map>
+
+namespace KDDockWidgets {
+class MDIResizeCoordinator;
+}
+
 namespace KDDockWidgets::Core {
 
 class Layout::Private : public LayoutingHost
@@ -32,6 +39,25 @@ public:
     KDBindings::Signal<int> visibleWidgetCountChanged;
 
     bool m_viewDeleted = false;
+
+    /// Flat views over the item tree, for the queries which are called very often
+    /// (itemForGroup(), groups(), etc.). Rebuilt lazily, when structureGeneration() changes.
+    struct ItemIndex
+    {
+        uint64_t structureGeneration = 0;
+        Vector<Core::Item *> items;
+        Vector<Core::Group *> groups;
+        std::unordered_map<const LayoutingGuest *, Core::Item *> itemsByGuest;
+    };
+
+    const ItemIndex &itemIndex() const;
+    void invalidateItemIndex();
+
+    /// Only created for MDILayout, when the 1st group gets a resize handler
+    std::unique_ptr<MDIResizeCoordinator> m_mdiResizeCoordinator;
+
+private:
+    mutable ItemIndex m_itemIndex;
 };
 
 }
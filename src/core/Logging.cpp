@@ -10,3 +10,19 @@
 */
 
 #include "Logging_p.h"
+
+#ifdef KDDW_HAS_SPDLOG
+
+spdlog::logger *KDDockWidgets::spdlogLogger()
+{
+    static const std::shared_ptr<spdlog::logger> s_logger = [] {
+        auto logger = spdlog::get(KDDockWidgets::spdlogLoggerName());
+        if (!logger)
+            logger = spdlog::stdout_color_mt(KDDockWidgets::spdlogLoggerName());
+        return logger;
+    }();
+
+    return s_logger.get();
+}
+
+#endif
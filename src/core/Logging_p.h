@@ -28,29 +28,99 @@
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 
-#define KDDW_LOG(level, ...)                                                     \
-    if (spdlog::should_log(level)) {                                             \
-        auto logger = spdlog::get(KDDockWidgets::spdlogLoggerName());            \
-        if (!logger) {                                                           \
-            logger = spdlog::stdout_color_mt(KDDockWidgets::spdlogLoggerName()); \
-        }                                                                        \
-        if (logger->should_log(level)) {                                         \
-            logger->log(level, __VA_ARGS__);                                     \
-        }                                                                        \
+#ifndef KDDW_LOG_THROTTLE_MS
+#define KDDW_LOG_THROTTLE_MS 500
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace KDDockWidgets {
+
+/// Returns the logger named spdlogLoggerName(), creating it if it isn't registered yet.
+/// It's resolved only once, as spdlog::get() takes the registry mutex and we log from hot paths.
+/// This means a custom logger must be registered before KDDW logs anything.
+DOCKS_EXPORT spdlog::logger *spdlogLogger();
+
+/// Lets through at most one message per interval. Each throttled call site has its own.
+/// Used for messages that would otherwise be printed for every mouse move.
+class LogThrottle
+{
+public:
+    /// Returns whether a message can be logged now. @p suppressed is set to the number of messages
+    /// that were dropped since the last one that went through.
+    bool tryAcquire(int intervalMs, uint32_t &suppressed)
+    {
+        const int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                std::chrono::steady_clock::now().time_since_epoch())
+                                .count();
+        int64_t last = m_lastMs.load(std::memory_order_relaxed);
+        if (last != 0 && now - last < intervalMs) {
+            m_suppressed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        if (!m_lastMs.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+            // Another thread just logged
+            m_suppressed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        suppressed = m_suppressed.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+
+private:
+    std::atomic<int64_t> m_lastMs = { 0 };
+    std::atomic<uint32_t> m_suppressed = { 0 };
+};
+
+}
+
+#define KDDW_LOG(level, ...)                                              \
+    if (spdlog::should_log(level)) {                                      \
+        spdlog::logger *kddw_logger = KDDockWidgets::spdlogLogger();      \
+        if (kddw_logger->should_log(level)) {                             \
+            kddw_logger->log(level, __VA_ARGS__);                         \
+        }                                                                 \
     }
 
+/// Like KDDW_LOG, but prints at most one message every KDDW_LOG_THROTTLE_MS for this call site.
+/// For messages in mouse move handlers and alike, which would otherwise flood the output.
+#define KDDW_LOG_THROTTLED(level, ...)                                                                    \
+    do {                                                                                                  \
+        if (spdlog::should_log(level)) {                                                                  \
+            spdlog::logger *kddw_logger = KDDockWidgets::spdlogLogger();                                  \
+            if (kddw_logger->should_log(level)) {                                                         \
+                static KDDockWidgets::LogThrottle kddw_throttle;                                          \
+                uint32_t kddw_suppressed = 0;                                                             \
+                if (kddw_throttle.tryAcquire(KDDW_LOG_THROTTLE_MS, kddw_suppressed)) {                    \
+                    if (kddw_suppressed > 0)                                                              \
+                        kddw_logger->log(level, "({} similar messages suppressed)", kddw_suppressed);     \
+                    kddw_logger->log(level, __VA_ARGS__);                                                 \
+                }                                                                                         \
+            }                                                                                             \
+        }                                                                                                 \
+    } while (0)
+
 #define KDDW_ERROR(...) KDDW_LOG(spdlog::level::err, __VA_ARGS__)
 #define KDDW_WARN(...) KDDW_LOG(spdlog::level::warn, __VA_ARGS__)
 #define KDDW_INFO(...) KDDW_LOG(spdlog::level::info, __VA_ARGS__)
 #define KDDW_DEBUG(...) KDDW_LOG(spdlog::level::debug, __VA_ARGS__)
 #define KDDW_TRACE(...) KDDW_LOG(spdlog::level::trace, __VA_ARGS__)
 
+#define KDDW_DEBUG_THROTTLED(...) KDDW_LOG_THROTTLED(spdlog::level::debug, __VA_ARGS__)
+#define KDDW_TRACE_THROTTLED(...) KDDW_LOG_THROTTLED(spdlog::level::trace, __VA_ARGS__)
+
 #else
 
 #define KDDW_WARN(...) (( void )0)
 #define KDDW_INFO(...) (( void )0)
 #define KDDW_DEBUG(...) (( void )0)
 #define KDDW_TRACE(...) (( void )0)
+#define KDDW_DEBUG_THROTTLED(...) (( void )0)
+#define KDDW_TRACE_THROTTLED(...) (( void )0)
 
 #ifdef KDDW_FRONTEND_QT
 
@@ -101,6 +171,56 @@ void printQWarning(Args &&...args)
 
 #endif
 
+/// Debug and trace messages of the busier subsystems are also tagged with a category, so they can
+/// be compiled out individually, by defining KDDW_NO_LOG_LAYOUTING, KDDW_NO_LOG_DRAG,
+/// KDDW_NO_LOG_RESTORE or KDDW_NO_LOG_FOCUS. Warnings and errors are never compiled out.
+/// Usage: KDDW_DEBUG_CAT(DRAG, "format {}", arg);
+
+#ifdef KDDW_NO_LOG_LAYOUTING
+#define KDDW_LOG_CATEGORY_LAYOUTING false
+#else
+#define KDDW_LOG_CATEGORY_LAYOUTING true
+#endif
+
+#ifdef KDDW_NO_LOG_DRAG
+#define KDDW_LOG_CATEGORY_DRAG false
+#else
+#define KDDW_LOG_CATEGORY_DRAG true
+#endif
+
+#ifdef KDDW_NO_LOG_RESTORE
+#define KDDW_LOG_CATEGORY_RESTORE false
+#else
+#define KDDW_LOG_CATEGORY_RESTORE true
+#endif
+
+#ifdef KDDW_NO_LOG_FOCUS
+#define KDDW_LOG_CATEGORY_FOCUS false
+#else
+#define KDDW_LOG_CATEGORY_FOCUS true
+#endif
+
+#define KDDW_DEBUG_CAT(category, ...)               \
+    do {                                            \
+        if constexpr (KDDW_LOG_CATEGORY_##category) \
+            KDDW_DEBUG(__VA_ARGS__);                \
+    } while (0)
+#define KDDW_TRACE_CAT(category, ...)               \
+    do {                                            \
+        if constexpr (KDDW_LOG_CATEGORY_##category) \
+            KDDW_TRACE(__VA_ARGS__);                \
+    } while (0)
+#define KDDW_DEBUG_THROTTLED_CAT(category, ...)     \
+    do {                                            \
+        if constexpr (KDDW_LOG_CATEGORY_##category) \
+            KDDW_DEBUG_THROTTLED(__VA_ARGS__);      \
+    } while (0)
+#define KDDW_TRACE_THROTTLED_CAT(category, ...)     \
+    do {                                            \
+        if constexpr (KDDW_LOG_CATEGORY_##category) \
+            KDDW_TRACE_THROTTLED(__VA_ARGS__);      \
+    } while (0)
+
 template<typename CharT, typename Traits>
 std::basic_ostream<CharT, Traits> &operator<<(std::basic_ostream<CharT, Traits> &os, KDDockWidgets::Size size)
 {
@@ -775,6 +775,11 @@ bool MainWindow::deserialize(const LayoutSaver::MainWindow &mw)
 }
 
 LayoutSaver::MainWindow MainWindow::serialize() const
+{
+    return serialize(/*includeLayout=*/true);
+}
+
+LayoutSaver::MainWindow MainWindow::serialize(bool includeLayout) const
 {
     LayoutSaver::MainWindow m;
 
@@ -787,7 +792,8 @@ LayoutSaver::MainWindow MainWindow::serialize() const
     m.uniqueName = uniqueName();
     m.screenIndex = Platform::instance()->screenNumberForView(view());
     m.screenSize = Platform::instance()->screenSizeFor(view());
-    m.multiSplitterLayout = layout()->serialize();
+    if (includeLayout)
+        m.multiSplitterLayout = layout()->serialize();
     m.affinities = d->affinities;
     m.windowState = window ? window->windowState() : WindowState::None;
 
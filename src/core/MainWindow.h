@@ -279,6 +279,10 @@ private:
     friend class KDDockWidgets::LayoutSaver;
     bool deserialize(const LayoutSaver::MainWindow &);
     LayoutSaver::MainWindow serialize() const;
+
+    /// Like serialize(), but allows to skip the layout, which is the expensive part.
+    /// Used by LayoutSaver::serializeLayoutDelta(), when the layout didn't change.
+    LayoutSaver::MainWindow serialize(bool includeLayout) const;
 };
 }
 }
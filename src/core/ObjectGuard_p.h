@@ -30,8 +30,13 @@ using ObjectGuard = QT_PREPEND_NAMESPACE(QPointer<T>);
 #include "Controller_p.h"
 #include "core/layouting/Item_p.h"
 
+#include <type_traits>
+#include <utility>
+
 namespace KDDockWidgets::Core {
 
+/// Holds a reference to the object's WeakRefControlBlock, doesn't connect to any signal.
+/// So it's only 2 pointers big and copying it doesn't allocate.
 template<typename T>
 class ObjectGuard
 {
@@ -44,8 +49,31 @@ public:
     }
 
     ObjectGuard(const ObjectGuard &other)
+        : obj(other.obj)
+        , controlBlock(other.controlBlock)
+    {
+        if (controlBlock)
+            controlBlock->ref();
+    }
+
+    ObjectGuard(ObjectGuard &&other) noexcept
+        : obj(std::exchange(other.obj, nullptr))
+        , controlBlock(std::exchange(other.controlBlock, nullptr))
+    {
+    }
+
+    ObjectGuard &operator=(const ObjectGuard &other)
+    {
+        ObjectGuard copy(other);
+        swap(copy);
+        return *this;
+    }
+
+    ObjectGuard &operator=(ObjectGuard &&other) noexcept
     {
-        setObject(other.obj);
+        ObjectGuard moved(std::move(other));
+        swap(moved);
+        return *this;
     }
 
     ObjectGuard &
@@ -62,55 +90,77 @@ public:
 
     operator bool() const
     {
-        return obj != nullptr;
+        return data() != nullptr;
     }
 
     bool isNull() const
     {
-        return obj == nullptr;
+        return data() == nullptr;
     }
 
     T *operator->() const
     {
-        return obj;
+        return data();
     }
 
     operator T *() const
     {
-        return obj;
+        return data();
     }
 
     T *data() const
     {
+        if (controlBlock && !controlBlock->isAlive())
+            return nullptr;
+
         return obj;
     }
 
     void clear()
     {
-        if (obj) {
-            conn = KDBindings::ScopedConnection();
-            obj = nullptr;
+        obj = nullptr;
+        if (controlBlock) {
+            controlBlock->deref();
+            controlBlock = nullptr;
         }
     }
 
 private:
+    void swap(ObjectGuard &other) noexcept
+    {
+        std::swap(obj, other.obj);
+        std::swap(controlBlock, other.controlBlock);
+    }
+
     void setObject(T *o)
     {
-        if (obj == o)
+        if (o && o == data())
             return;
 
         clear();
-        obj = o;
+        if (!o)
+            return;
+
+        const Core::Object *object = nullptr;
+        if constexpr (std::is_base_of_v<Core::Object, T>) {
+            object = o;
+        } else {
+            object = dynamic_cast<const Core::Object *>(o);
+        }
 
-        if (auto object = dynamic_cast<Core::Object *>(o)) {
-            conn = object->aboutToBeDeleted.connect([this] {
-                obj = nullptr;
-            });
+        if (object) {
+            controlBlock = object->acquireWeakRef();
+            if (!controlBlock) {
+                // Already being destroyed, counts as deleted
+                return;
+            }
         }
+
+        obj = o;
     }
 
     T *obj = nullptr;
-    KDBindings::ScopedConnection conn;
+    WeakRefControlBlock *controlBlock = nullptr;
 };
 
 }
@@ -12,6 +12,7 @@
 #pragma once
 
 #include "core/Platform.h"
+#include "core/DelayedCall_p.h"
 #include "kdbindings/signal.h"
 
 #include <memory>
@@ -43,6 +44,9 @@ public:
     bool m_inDestruction = false;
 
     std::vector<EventFilterInterface *> m_globalEventFilters;
+
+    /// Delayed calls should be scheduled here, rather than calling runDelayed() directly
+    DelayedCallQueue delayedCallQueue;
 };
 
 }
@@ -31,11 +31,23 @@
 
 using namespace KDDockWidgets;
 
+static uint64_t s_lastPositionGeneration = 0;
+
+Position::Position()
+    : m_generation(++s_lastPositionGeneration)
+{
+}
+
 Position::~Position()
 {
     m_placeholders.clear();
 }
 
+void Position::setChanged()
+{
+    m_generation = ++s_lastPositionGeneration;
+}
+
 void Position::addPlaceholderItem(Core::Item *placeholder)
 {
     assert(placeholder);
@@ -59,6 +71,7 @@ void Position::addPlaceholderItem(Core::Item *placeholder)
     auto conn = placeholder->deleted.connect([this, placeholder] { removePlaceholder(placeholder); });
 
     m_placeholders.push_back(std::make_unique<ItemRef>(conn, placeholder));
+    setChanged();
 
     // NOTE: We use a list instead of simply two variables to keep the placeholders, because
     // a placeholder from a FloatingWindow might become a MainWindow one without we knowing,
@@ -93,6 +106,7 @@ void Position::removePlaceholders()
 {
     ScopedValueRollback clearGuard(m_clearing, true);
     m_placeholders.clear();
+    setChanged();
 }
 
 void Position::removePlaceholders(const Core::LayoutingHost *host)
@@ -104,6 +118,7 @@ void Position::removePlaceholders(const Core::LayoutingHost *host)
                                             return host == itemref->item->host();
                                         }),
                          m_placeholders.end());
+    setChanged();
 }
 
 void Position::removeNonMainWindowPlaceholders()
@@ -116,6 +131,7 @@ void Position::removeNonMainWindowPlaceholders()
         else
             ++it;
     }
+    setChanged();
 }
 
 void Position::removePlaceholder(Core::Item *placeholder)
@@ -128,6 +144,7 @@ void Position::removePlaceholder(Core::Item *placeholder)
                                             return itemref->item == placeholder || !itemref->item;
                                         }),
                          m_placeholders.end());
+    setChanged();
 }
 
 void Position::deserialize(const LayoutSaver::Position &lp)
@@ -176,6 +193,7 @@ void Position::deserialize(const LayoutSaver::Position &lp)
 
     m_tabIndex = lp.tabIndex;
     m_wasFloating = lp.wasFloating;
+    setChanged();
 }
 
 LayoutSaver::Position Position::serialize() const
@@ -24,6 +24,7 @@
 
 #include <kdbindings/signal.h>
 
+#include <cstdint>
 #include <memory>
 #include <unordered_map>
 
@@ -64,7 +65,7 @@ class DOCKS_EXPORT_FOR_UNIT_TESTS Position
     KDDW_DELETE_COPY_CTOR(Position)
 public:
     typedef std::shared_ptr<Position> Ptr;
-    Position() = default;
+    Position();
     ~Position();
 
     void deserialize(const LayoutSaver::Position &);
@@ -89,6 +90,7 @@ public:
     }
 
     ///@brief The tab index in case the dock widget was in a TabWidget, -1 otherwise.
+    /// Use saveTabIndex() to change it.
     int m_tabIndex = -1;
 
     ///@brief true if the DockWidget was floating when it was closed
@@ -121,11 +123,13 @@ public:
     {
         m_tabIndex = tabIndex;
         m_wasFloating = isFloating;
+        setChanged();
     }
 
     void setLastFloatingGeometry(Rect geo)
     {
         m_lastFloatingGeometry = geo;
+        setChanged();
     }
 
     bool wasFloating() const
@@ -154,18 +158,36 @@ public:
         return it == m_lastOverlayedGeometries.cend() ? Rect() : it->second;
     }
 
+    const std::unordered_map<SideBarLocation, Rect> &lastOverlayedGeometries() const
+    {
+        return m_lastOverlayedGeometries;
+    }
+
     void setLastOverlayedGeometry(SideBarLocation loc, Rect rect)
     {
         m_lastOverlayedGeometries[loc] = rect;
+        setChanged();
+    }
+
+    /// Returns a number which changes whenever this position changes. Allows for cheap dirty
+    /// checking. Numbers are never reused, not even by other positions.
+    /// The placeholders' indexes aren't covered, they change with their layout's
+    /// LayoutingHost::structureGeneration().
+    uint64_t generation() const
+    {
+        return m_generation;
     }
 
 private:
+    void setChanged();
+
     // The last places where this dock widget was (or is), so it can be restored when
     // setFloating(false) or show() is called.
     std::vector<std::unique_ptr<ItemRef>> m_placeholders;
     Rect m_lastFloatingGeometry;
     std::unordered_map<SideBarLocation, Rect> m_lastOverlayedGeometries;
     bool m_clearing = false; // to prevent re-entrancy
+    uint64_t m_generation = 0;
 };
 
 }
@@ -0,0 +1,99 @@
+/*
+  This file is part of KDDockWidgets.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#pragma once
+
+#include "KDDockWidgets.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace KDDockWidgets {
+
+namespace Core {
+
+/// A grid over an area where each cell lists the rects intersecting it.
+/// Finds the rect under the cursor without testing every rect, for code running on each mouse move.
+template<typename T>
+class RectGrid
+{
+public:
+    /// Replaces the grid's contents. When rects overlap, the one that comes first wins.
+    void rebuild(std::vector<std::pair<Rect, T>> entries, Size areaSize)
+    {
+        m_entries = std::move(entries);
+
+        // Roughly one rect per cell
+        m_numCells = std::max(1, int(std::ceil(std::sqrt(double(m_entries.size())))));
+        m_cellSize = Size(std::max(1, (areaSize.width() + m_numCells - 1) / m_numCells),
+                          std::max(1, (areaSize.height() + m_numCells - 1) / m_numCells));
+
+        m_cells.assign(size_t(m_numCells * m_numCells), {});
+        for (int i = 0; i < int(m_entries.size()); ++i) {
+            const Rect rect = m_entries[size_t(i)].first;
+            if (rect.isEmpty())
+                continue;
+
+            const int firstColumn = column(rect.left());
+            const int lastColumn = column(rect.right());
+            const int firstRow = row(rect.top());
+            const int lastRow = row(rect.bottom());
+            for (int r = firstRow; r <= lastRow; ++r) {
+                for (int c = firstColumn; c <= lastColumn; ++c)
+                    m_cells[size_t(r * m_numCells + c)].push_back(i);
+            }
+        }
+    }
+
+    /// Returns the first entry containing @p pos for which @p accept returns true.
+    /// Returns T() if there's none.
+    template<typename Accept>
+    T find(Point pos, Accept accept) const
+    {
+        if (m_cells.empty())
+            return T();
+
+        // Rects can stick out of the area, so clamp instead of bailing out
+        for (int i : m_cells[size_t(row(pos.y()) * m_numCells + column(pos.x()))]) {
+            const auto &entry = m_entries[size_t(i)];
+            if (entry.first.contains(pos) && accept(entry.second))
+                return entry.second;
+        }
+
+        return T();
+    }
+
+    T find(Point pos) const
+    {
+        return find(pos, [](const T &) { return true; });
+    }
+
+private:
+    int column(int x) const
+    {
+        return std::clamp(x / m_cellSize.width(), 0, m_numCells - 1);
+    }
+
+    int row(int y) const
+    {
+        return std::clamp(y / m_cellSize.height(), 0, m_numCells - 1);
+    }
+
+    int m_numCells = 0; // Per row and per column
+    Size m_cellSize;
+    std::vector<std::pair<Rect, T>> m_entries;
+    std::vector<std::vector<int>> m_cells;
+};
+
+}
+
+}
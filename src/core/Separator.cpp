@@ -19,6 +19,10 @@
 #include "Platform.h"
 #include "Controller.h"
 #include "core/ViewFactory.h"
+#include "core/DelayedCall_p.h"
+#include "core/Platform_p.h"
+
+#include <chrono>
 
 
 #ifdef Q_OS_WIN
@@ -81,11 +85,59 @@ struct Separator::Private : public LayoutingSeparator
         q->view()->raise();
     }
 
+    /// Moves the separator to the latest mouse position, if a coalesced move is pending
+    void applyPendingMove()
+    {
+        if (!hasPendingMove)
+            return;
+
+        hasPendingMove = false;
+        lastMoveTime = std::chrono::steady_clock::now();
+        LayoutingSeparator::onMouseMove(pendingMovePos, /*moveSeparator=*/true);
+    }
+
     Core::Separator *const q;
     Rect m_geometry;
     int lazyPosition = 0;
     View *lazyResizeRubberBand = nullptr;
     const bool usesLazyResize = Config::self().flags() & Config::Flag_LazyResize;
+
+    // For Config::separatorMoveInterval()
+    Point pendingMovePos;
+    bool hasPendingMove = false;
+    bool moveScheduled = false;
+    std::chrono::steady_clock::time_point lastMoveTime;
+};
+
+/// Applies a Separator's coalesced move, see Config::setSeparatorMoveInterval()
+class Separator::DelayedMove : public DelayedCall
+{
+public:
+    explicit DelayedMove(Separator *separator)
+        : m_separator(separator)
+    {
+    }
+
+    void call() override
+    {
+        if (m_separator) {
+            m_separator->d->moveScheduled = false;
+            m_separator->d->applyPendingMove();
+        }
+    }
+
+    const void *target() const override
+    {
+        return m_separator.data();
+    }
+
+    bool isDuplicateOf(const DelayedCall &other) const override
+    {
+        return dynamic_cast<const DelayedMove *>(&other) != nullptr;
+    }
+
+private:
+    ObjectGuard<Separator> m_separator;
 };
 
 namespace {
@@ -170,7 +222,7 @@ void Separator::onMousePress()
 {
     d->onMousePress();
 
-    KDDW_DEBUG("Drag started");
+    KDDW_DEBUG_CAT(LAYOUTING, "Drag started");
 
     if (d->lazyResizeRubberBand) {
         setLazyPosition(position());
@@ -182,6 +234,9 @@ void Separator::onMousePress()
 
 void Separator::onMouseReleased()
 {
+    // Exact on release, the last position wins
+    d->applyPendingMove();
+
     if (d->lazyResizeRubberBand) {
         d->lazyResizeRubberBand->hide();
         d->m_parentContainer->requestSeparatorMove(d, d->lazyPosition - position());
@@ -206,7 +261,7 @@ void Separator::onMouseMove(Point pos)
         // Workaround a bug in Qt where we're getting mouse moves without without the button being
         // pressed
         if (!Platform::instance()->isLeftMouseButtonPressed()) {
-            KDDW_DEBUG(
+            KDDW_DEBUG_THROTTLED_CAT(LAYOUTING,
                 "Separator::onMouseMove: Ignoring spurious mouse event. Someone ate our ReleaseEvent");
             onMouseReleased();
             return;
@@ -217,7 +272,7 @@ void Separator::onMouseMove(Point pos)
         const bool mouseButtonIsReallyDown =
             (GetKeyState(VK_LBUTTON) & 0x8000) || (GetKeyState(VK_RBUTTON) & 0x8000);
         if (!mouseButtonIsReallyDown) {
-            KDDW_DEBUG(
+            KDDW_DEBUG_THROTTLED_CAT(LAYOUTING,
                 "Separator::onMouseMove: Ignoring spurious mouse event. Someone ate our ReleaseEvent");
             onMouseReleased();
             return;
@@ -229,6 +284,19 @@ void Separator::onMouseMove(Point pos)
         const int positionToGoTo = d->onMouseMove(pos, /*moveSeparator=*/false);
         if (positionToGoTo != -1)
             setLazyPosition(positionToGoTo);
+    } else if (const int interval = Config::self().separatorMoveInterval()) {
+        d->pendingMovePos = pos;
+        d->hasPendingMove = true;
+
+        using namespace std::chrono;
+        const auto elapsed = duration_cast<milliseconds>(steady_clock::now() - d->lastMoveTime);
+        if (elapsed.count() >= interval) {
+            d->applyPendingMove();
+        } else if (!d->moveScheduled) {
+            d->moveScheduled = true;
+            Platform::instance()->d->delayedCallQueue.schedule(
+                int(interval - elapsed.count()), new DelayedMove(this));
+        }
     } else {
         d->onMouseMove(pos, /*moveSeparator=*/true);
     }
@@ -64,6 +64,7 @@ private:
 
     struct Private;
     Private *const d;
+    class DelayedMove;
 };
 
 }
@@ -478,7 +478,8 @@ void TitleBar::onFloatClicked()
                         current = dock;
 
                     dock->setFloating(true);
-                    dock->dptr()->m_lastPosition->m_tabIndex = i;
+                    const auto lastPosition = dock->dptr()->m_lastPosition;
+                    lastPosition->saveTabIndex(i, lastPosition->wasFloating());
                     dock->setFloating(false);
                     ++i;
                 }
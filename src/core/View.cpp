@@ -58,6 +58,7 @@ View::View(Controller *controller, ViewType type)
 View::~View()
 {
     m_inDtor = true;
+    d->m_weakRefs.invalidate();
     d->beingDestroyed.emit();
 
     if (!d->freed() && !View::is(ViewType::ViewWrapper) && !View::is(ViewType::DropAreaIndicatorOverlay)) {
@@ -12,6 +12,7 @@
 #include "ViewGuard.h"
 #include "View.h"
 #include "core/View_p.h"
+#include "core/WeakRef_p.h"
 
 using namespace KDDockWidgets;
 using namespace KDDockWidgets::Core;
@@ -22,8 +23,11 @@ ViewGuard::ViewGuard(View *view)
 }
 
 ViewGuard::ViewGuard(const ViewGuard &other)
+    : v(other.v)
+    , m_controlBlock(other.m_controlBlock)
 {
-    setView(other.view());
+    if (m_controlBlock)
+        m_controlBlock->ref();
 }
 
 ViewGuard::~ViewGuard()
@@ -38,27 +42,33 @@ ViewGuard::operator bool() const
 
 bool ViewGuard::isNull() const
 {
-    return v == nullptr;
+    return view() == nullptr;
 }
 
 View *ViewGuard::operator->()
 {
-    return v;
+    return view();
 }
 
 const View *ViewGuard::operator->() const
 {
-    return v;
+    return view();
 }
 
 void ViewGuard::clear()
 {
     v = nullptr;
-    m_onDestroy.disconnect();
+    if (m_controlBlock) {
+        m_controlBlock->deref();
+        m_controlBlock = nullptr;
+    }
 }
 
 View *ViewGuard::view() const
 {
+    if (m_controlBlock && !m_controlBlock->isAlive())
+        return nullptr;
+
     return v;
 }
 
@@ -79,7 +89,7 @@ ViewGuard &ViewGuard::operator=(const ViewGuard &other)
 
 void ViewGuard::setView(View *view)
 {
-    if (view == v)
+    if (view && view == this->view())
         return;
 
     if (view && view->inDtor()) {
@@ -90,9 +100,10 @@ void ViewGuard::setView(View *view)
     }
 
     clear();
-    v = view;
 
-    if (v) {
-        m_onDestroy = v->d->beingDestroyed.connect([this] { v = nullptr; });
+    if (view) {
+        m_controlBlock = view->d->m_weakRefs.acquire();
+        if (m_controlBlock)
+            v = view;
     }
 }
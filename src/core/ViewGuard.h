@@ -14,12 +14,11 @@
 
 #include "kddockwidgets/docks_export.h"
 
-#include "kdbindings/signal.h"
-
 namespace KDDockWidgets {
 
 namespace Core {
 class View;
+class WeakRefControlBlock;
 
 /// @brief This class provides a weak reference to a view
 /// i.e., it becomes null automatically once a View is destroyed
@@ -43,7 +42,7 @@ public:
 private:
     void setView(View *);
     View *v = nullptr;
-    KDBindings::ConnectionHandle m_onDestroy;
+    WeakRefControlBlock *m_controlBlock = nullptr;
 };
 
 }
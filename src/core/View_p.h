@@ -15,6 +15,7 @@
 #include "core/View.h"
 #include "kdbindings/signal.h"
 #include "QtCompat_p.h"
+#include "WeakRef_p.h"
 
 #include <vector>
 #include <memory>
@@ -46,9 +47,15 @@ public:
     /// @brief signal emitted when the view is resized
     KDBindings::Signal<Size> resized;
 
+    /// @brief signal emitted when raise() is called on the view. Not emitted by wrappers.
+    KDBindings::Signal<> raised;
+
     /// List of event filters
     std::vector<EventFilterInterface *> m_viewEventFilters;
 
+    /// For ViewGuard
+    WeakRefTracker m_weakRefs;
+
     /// @brief Returns the views's geometry, but always in global space
     Rect globalGeometry() const;
 
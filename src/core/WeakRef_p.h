@@ -0,0 +1,94 @@
+/*
+  This file is part of KDDockWidgets.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#pragma once
+
+/// Intrusive weak references, used by ObjectGuard and ViewGuard.
+/// The guarded object owns a WeakRefTracker, guards hold a reference to its control block.
+/// Guards don't need to connect to any signal, so they're cheap to create and copy.
+/// Like the objects they guard, these aren't thread-safe.
+
+namespace KDDockWidgets::Core {
+
+class WeakRefControlBlock
+{
+public:
+    /// Returns false once the tracked object started being destroyed
+    bool isAlive() const
+    {
+        return m_alive;
+    }
+
+    void ref()
+    {
+        ++m_refCount;
+    }
+
+    void deref()
+    {
+        if (--m_refCount == 0)
+            delete this;
+    }
+
+private:
+    friend class WeakRefTracker;
+    WeakRefControlBlock() = default;
+    WeakRefControlBlock(const WeakRefControlBlock &) = delete;
+    WeakRefControlBlock &operator=(const WeakRefControlBlock &) = delete;
+
+    int m_refCount = 1; // The tracker's reference
+    bool m_alive = true;
+};
+
+class WeakRefTracker
+{
+public:
+    WeakRefTracker() = default;
+
+    ~WeakRefTracker()
+    {
+        invalidate();
+    }
+
+    /// Returns the control block, already ref'ed for the caller.
+    /// The control block is only created when the object is guarded for the 1st time.
+    /// Returns nullptr if the object is already being destroyed.
+    WeakRefControlBlock *acquire() const
+    {
+        if (m_invalidated)
+            return nullptr;
+
+        if (!m_block)
+            m_block = new WeakRefControlBlock();
+
+        m_block->ref();
+        return m_block;
+    }
+
+    /// Called by the tracked object once it starts being destroyed. Guards become null.
+    void invalidate()
+    {
+        m_invalidated = true;
+        if (m_block) {
+            m_block->m_alive = false;
+            m_block->deref();
+            m_block = nullptr;
+        }
+    }
+
+private:
+    WeakRefTracker(const WeakRefTracker &) = delete;
+    WeakRefTracker &operator=(const WeakRefTracker &) = delete;
+
+    mutable WeakRefControlBlock *m_block = nullptr;
+    bool m_invalidated = false;
+};
+
+}
@@ -19,11 +19,14 @@
 
 #include "kddockwidgets/core/DockRegistry.h"
 #include "kddockwidgets/core/MDILayout.h"
+#include "kddockwidgets/core/Group.h"
+#include "core/Layout_p.h"
 #include "kddockwidgets/core/TitleBar.h"
 #include "kddockwidgets/core/FloatingWindow.h"
 #include "kddockwidgets/core/Platform.h"
 #include "core/ScopedValueRollback_p.h"
 
+#include <algorithm>
 #include <cstdlib>
 
 #if defined(Q_OS_WIN)
@@ -68,7 +71,9 @@ WidgetResizeHandler::WidgetResizeHandler(EventFilterMode filterMode, WindowMode
 
 WidgetResizeHandler::~WidgetResizeHandler()
 {
-    if (m_usesGlobalEventFilter) {
+    if (m_mdiResizeCoordinator) {
+        m_mdiResizeCoordinator->removeHandler(this);
+    } else if (m_usesGlobalEventFilter) {
         Platform::instance()->removeGlobalEventFilter(this);
     } else if (mTargetGuard) {
         mTarget->removeViewEventFilter(this);
@@ -134,8 +139,12 @@ bool WidgetResizeHandler::onMouseEvent(View *widget, MouseEvent *e)
             // Not needed to mess with the cursor, it gets set when moving over another window.
             return false;
         }
-    } else if (isMDI()) {
+    } else if (!m_mdiResizeCoordinator && isMDI()) {
         // Case #2: Resizing an embedded MDI "Window"
+        // Not needed with a MDIResizeCoordinator, as it only forwards to us if the cursor is over
+        // our group, or if it's over no group and we're the topmost group whose margins contain it.
+        // Either way the cursor isn't over a sibling group. This is the fallback for when there's
+        // no coordinator.
 
         // Each Group has a WidgetResizeHandler instance.
         // mTarget is the Group we want to resize.
@@ -220,9 +229,12 @@ bool WidgetResizeHandler::onMouseEvent(View *widget, MouseEvent *e)
             break;
 
         if (isMDI()) {
-            const Core::Group *groupBeingResized = DockRegistry::self()->groupInMDIResize();
-            const bool otherGroupBeingResized =
-                groupBeingResized && groupBeingResized->view() != mTarget;
+            // With a coordinator, the group being resized is its active handler's.
+            // No need to look at every group then.
+            const bool otherGroupBeingResized = m_mdiResizeCoordinator
+                ? (m_mdiResizeCoordinator->activeHandler()
+                   && m_mdiResizeCoordinator->activeHandler() != this)
+                : isOtherGroupInMDIResize();
             if (otherGroupBeingResized) {
                 // only one at a time!
                 return false;
@@ -239,6 +251,12 @@ bool WidgetResizeHandler::onMouseEvent(View *widget, MouseEvent *e)
     return false;
 }
 
+bool WidgetResizeHandler::isOtherGroupInMDIResize() const
+{
+    const Core::Group *groupBeingResized = DockRegistry::self()->groupInMDIResize();
+    return groupBeingResized && groupBeingResized->view() != mTarget;
+}
+
 bool WidgetResizeHandler::mouseMoveEvent(MouseEvent *e)
 {
     const Point globalPos = Qt5Qt6Compat::eventGlobalPos(e);
@@ -512,7 +530,18 @@ void WidgetResizeHandler::setTarget(View *w)
         mTarget = w;
         mTargetGuard = w;
         mTarget->setMouseTracking(true);
-        if (m_usesGlobalEventFilter) {
+        if (m_usesGlobalEventFilter && !m_isTopLevelWindowResizer)
+            m_mdiResizeCoordinator = MDIResizeCoordinator::forTarget(w);
+
+        if (m_mdiResizeCoordinator) {
+            m_mdiResizeCoordinator->addHandler(this);
+            // Programmatic raises change the z-order without any click going through the
+            // coordinator
+            m_raisedConnection = w->d->raised.connect([this] {
+                if (m_mdiResizeCoordinator)
+                    m_mdiResizeCoordinator->setZOrderDirty();
+            });
+        } else if (m_usesGlobalEventFilter) {
             Platform::instance()->installGlobalEventFilter(this);
         } else {
             mTarget->installViewEventFilter(this);
@@ -740,12 +769,196 @@ bool NCHITTESTEventFilter::nativeEventFilter(const QByteArray &eventType, void *
 }
 #endif
 
+MDIResizeCoordinator::MDIResizeCoordinator(Core::MDILayout *layout)
+    : m_layout(layout)
+{
+}
+
+MDIResizeCoordinator::~MDIResizeCoordinator()
+{
+    for (WidgetResizeHandler *handler : m_handlers)
+        handler->m_mdiResizeCoordinator = nullptr;
+
+    if (!m_handlers.empty())
+        Platform::instance()->removeGlobalEventFilter(this);
+}
+
+/*static*/
+MDIResizeCoordinator *MDIResizeCoordinator::forTarget(View *target)
+{
+    Core::Group *group = target ? target->asGroupController() : nullptr;
+    Core::MDILayout *layout = group ? group->mdiLayout() : nullptr;
+    if (!layout)
+        return nullptr;
+
+    auto &coordinator = layout->d_ptr()->m_mdiResizeCoordinator;
+    if (!coordinator)
+        coordinator = std::make_unique<MDIResizeCoordinator>(layout);
+
+    return coordinator.get();
+}
+
+void MDIResizeCoordinator::addHandler(WidgetResizeHandler *handler)
+{
+    if (m_handlers.empty())
+        Platform::instance()->installGlobalEventFilter(this);
+
+    m_handlers.push_back(handler);
+    m_zOrderDirty = true;
+}
+
+void MDIResizeCoordinator::removeHandler(WidgetResizeHandler *handler)
+{
+    m_handlers.erase(std::remove(m_handlers.begin(), m_handlers.end(), handler), m_handlers.end());
+    if (m_lastHandler == handler)
+        m_lastHandler = nullptr;
+    if (m_activeHandler == handler)
+        m_activeHandler = nullptr;
+
+    // m_grid still points to it
+    m_zOrderDirty = true;
+
+    if (m_handlers.empty())
+        Platform::instance()->removeGlobalEventFilter(this);
+}
+
+WidgetResizeHandler *MDIResizeCoordinator::activeHandler() const
+{
+    return m_activeHandler;
+}
+
+void MDIResizeCoordinator::setZOrderDirty()
+{
+    m_zOrderDirty = true;
+}
+
+void MDIResizeCoordinator::updateIndex()
+{
+    m_zOrderDirty = false;
+    m_layoutGeneration = m_layout->asLayoutingHost()->generation();
+
+    // Child views are ordered bottom to top. Groups are direct children of the MDI layout.
+    std::vector<WidgetResizeHandler *> sorted;
+    sorted.reserve(m_handlers.size());
+    const auto children = m_layout->view()->childViews();
+    for (auto i = children.size() - 1; i >= 0; --i) {
+        if (Core::Group *group = children.at(i)->asGroupController()) {
+            WidgetResizeHandler *handler = group->resizeHandler();
+            if (handler && handler->m_mdiResizeCoordinator == this)
+                sorted.push_back(handler);
+        }
+    }
+
+    if (sorted.size() != m_handlers.size()) {
+        // Shouldn't happen. Keep the ones we didn't find, below all others.
+        for (WidgetResizeHandler *handler : m_handlers) {
+            if (std::find(sorted.cbegin(), sorted.cend(), handler) == sorted.cend())
+                sorted.push_back(handler);
+        }
+    }
+
+    m_handlers = std::move(sorted);
+
+    const int margin = WidgetResizeHandler::widgetResizeHandlerMargin();
+    const Margins margins(margin, margin, margin, margin);
+    std::vector<std::pair<Rect, WidgetResizeHandler *>> entries;
+    entries.reserve(m_handlers.size());
+    for (WidgetResizeHandler *handler : m_handlers) {
+        if (handler->mTargetGuard)
+            entries.push_back({ handler->mTarget->geometry().marginsAdded(margins), handler });
+    }
+
+    m_grid.rebuild(std::move(entries), m_layout->view()->size());
+}
+
+WidgetResizeHandler *MDIResizeCoordinator::handlerAt(Point globalPos)
+{
+    if (m_zOrderDirty || m_layoutGeneration != m_layout->asLayoutingHost()->generation())
+        updateIndex();
+
+    // Geometry is from the last rebuild, but visibility and enabled state can change without
+    // bumping the layout's generation, so check those live
+    return m_grid.find(m_layout->view()->mapFromGlobal(globalPos),
+                       [](WidgetResizeHandler *handler) {
+                           return handler->enabled() && handler->mTargetGuard
+                               && handler->mTarget->isVisible();
+                       });
+}
+
+WidgetResizeHandler *MDIResizeCoordinator::handlerForEvent(View *view, Point globalPos)
+{
+    // The group being resized gets all events. Same for QtQuick, where the one enabled is the one
+    // whose MouseArea was pressed.
+    if (m_activeHandler && m_activeHandler->enabled()
+        && (m_activeHandler->isResizing() || m_activeHandler->m_eventFilteringStartsManually))
+        return m_activeHandler;
+
+    // If the cursor is over one of our groups, then it's that group's, even if it's near the
+    // margins of a sibling
+    auto f = view ? view->d->firstParentOfType(ViewType::Group) : nullptr;
+    auto group = f ? f->view()->asGroupController() : nullptr;
+    if (group && group->isMDIWrapper()) {
+        // We don't care about the inner Option_MDINestable helper group
+        group = group->mdiFrame();
+    }
+
+    if (group && group->mdiLayout() == m_layout) {
+        WidgetResizeHandler *handler = group->resizeHandler();
+        if (handler && handler->m_mdiResizeCoordinator == this && handler->enabled())
+            return handler;
+        return nullptr;
+    }
+
+    // Otherwise the cursor is outside of any group, but might still be within the resize margins
+    // of one of them
+    return handlerAt(globalPos);
+}
+
+bool MDIResizeCoordinator::onMouseEvent(View *view, MouseEvent *e)
+{
+    if (WidgetResizeHandler::s_disableAllHandlers)
+        return false;
+
+    const auto type = e->type();
+    if (type != Event::MouseButtonPress && type != Event::MouseButtonRelease
+        && type != Event::MouseMove)
+        return false;
+
+    WidgetResizeHandler *handler = handlerForEvent(view, Qt5Qt6Compat::eventGlobalPos(e));
+    if (m_lastHandler && m_lastHandler != handler)
+        m_lastHandler->restoreMouseCursor();
+    m_lastHandler = handler;
+
+    const bool consumed = handler && handler->onMouseEvent(view, e);
+
+    if (handler && handler->isResizing()) {
+        m_activeHandler = handler;
+    } else if (m_activeHandler == handler) {
+        // Resize ended. For QtQuick, the handler is still enabled until the release.
+        if (!handler || !handler->m_eventFilteringStartsManually || !handler->enabled())
+            m_activeHandler = nullptr;
+    }
+
+    // Clicking raises groups
+    if (type == Event::MouseButtonPress)
+        m_zOrderDirty = true;
+
+    return consumed;
+}
+
 void WidgetResizeHandler::setEventFilterStartsManually()
 {
     m_eventFilteringStartsManually = true;
     EventFilterInterface::setEnabled(false);
 }
 
+void WidgetResizeHandler::startEventFiltering()
+{
+    EventFilterInterface::setEnabled(true);
+    if (m_mdiResizeCoordinator)
+        m_mdiResizeCoordinator->m_activeHandler = this;
+}
+
 void WidgetResizeHandler::setHandlesMouseCursor(bool handles)
 {
     m_handlesMouseCursor = handles;
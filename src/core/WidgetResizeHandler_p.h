@@ -17,6 +17,12 @@
 #include "kddockwidgets/core/EventFilterInterface.h"
 #include "core/Window_p.h"
 #include "core/ViewGuard.h"
+#include "core/RectGrid_p.h"
+
+#include <kdbindings/signal.h>
+
+#include <cstdint>
+#include <vector>
 
 #if defined(Q_OS_WIN)
 #include <windows.h>
@@ -30,8 +36,11 @@ namespace KDDockWidgets {
 
 namespace Core {
 class FloatingWindow;
+class MDILayout;
 }
 
+class MDIResizeCoordinator;
+
 class DOCKS_EXPORT WidgetResizeHandler : public Core::Object, public Core::EventFilterInterface
 {
     Q_OBJECT
@@ -145,6 +154,9 @@ public:
     /// MDI windows, we only want the one being resized to filter for global mouse events
     void setEventFilterStartsManually();
 
+    /// For setEventFilterStartsManually(). Starts filtering events, until the mouse is released.
+    void startEventFiltering();
+
     /// Default true. Sets whether WidgetResizeHandler will change mouse cursor depending on where it is.
     /// This is false for QtQuick as there we use a MouseArea to change cursor.
     void setHandlesMouseCursor(bool);
@@ -165,10 +177,13 @@ public:
     static bool s_disableAllHandlers;
 
 private:
+    friend class MDIResizeCoordinator;
+
     // EventFilterInterface:
     bool onMouseEvent(Core::View *, MouseEvent *) override;
     void setTarget(Core::View *w);
     bool mouseMoveEvent(MouseEvent *);
+    bool isOtherGroupInMDIResize() const;
     void updateCursor(CursorPosition);
     void setMouseCursor(Qt::CursorShape);
     void restoreMouseCursor();
@@ -193,6 +208,64 @@ private:
     bool m_handlesMouseCursor = true;
 
     bool m_eventFilteringStartsManually = false;
+
+    /// Set when resizing a MDI group. The coordinator is the global event filter then, not us.
+    MDIResizeCoordinator *m_mdiResizeCoordinator = nullptr;
+
+    /// Tells the coordinator when our group is raised, so it re-sorts by z-order
+    KDBindings::ScopedConnection m_raisedConnection;
+};
+
+/// Forwards mouse events to the WidgetResizeHandlers of the groups in a MDILayout.
+///
+/// Instead of each group's handler being a global event filter, and all of them hit testing every
+/// mouse move, the coordinator is the single global event filter and forwards each event to one
+/// handler only: the one being resized, or else the one of the group under the cursor.
+class DOCKS_EXPORT MDIResizeCoordinator : public Core::EventFilterInterface
+{
+public:
+    explicit MDIResizeCoordinator(Core::MDILayout *);
+    ~MDIResizeCoordinator() override;
+
+    /// Returns the coordinator for @p target, if it's a group in a MDILayout. nullptr otherwise.
+    static MDIResizeCoordinator *forTarget(Core::View *target);
+
+    void addHandler(WidgetResizeHandler *);
+    void removeHandler(WidgetResizeHandler *);
+
+    /// Returns the handler which should get the mouse event, if any
+    WidgetResizeHandler *handlerForEvent(Core::View *, Point globalPos);
+
+    bool onMouseEvent(Core::View *, MouseEvent *) override;
+
+    /// Returns the handler of the group being resized, if any
+    WidgetResizeHandler *activeHandler() const;
+
+    /// Called when a group is raised, or anything else that changes the z-order
+    void setZOrderDirty();
+
+private:
+    friend class WidgetResizeHandler;
+    void updateIndex();
+    WidgetResizeHandler *handlerAt(Point globalPos);
+
+    Core::MDILayout *const m_layout;
+
+    /// Sorted by z-order, topmost first. Re-sorted when groups are raised, and when the layout
+    /// changes.
+    std::vector<WidgetResizeHandler *> m_handlers;
+
+    /// The groups' rects, including resize margins, so handlerAt() doesn't test every group.
+    /// Rebuilt together with m_handlers.
+    Core::RectGrid<WidgetResizeHandler *> m_grid;
+    bool m_zOrderDirty = true;
+    uint64_t m_layoutGeneration = 0;
+
+    /// The handler which got the previous event, so we can restore its cursor when leaving it
+    WidgetResizeHandler *m_lastHandler = nullptr;
+
+    /// The handler of the group being resized. Gets all events until the resize ends.
+    WidgetResizeHandler *m_activeHandler = nullptr;
 };
 
 #if defined(Q_OS_WIN) && defined(KDDW_FRONTEND_QTWIDGETS)
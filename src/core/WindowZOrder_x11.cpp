@@ -0,0 +1,223 @@
+/*
+  This file is part of KDDockWidgets.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include "WindowZOrder_x11_p.h"
+#include "DockRegistry.h"
+#include "Logging_p.h"
+
+#include <QGuiApplication>
+#include <QtGui/qpa/qplatformnativeinterface.h>
+
+#include <X11/Xatom.h>
+#include <X11/Xlib.h>
+#include <xcb/xcb.h>
+
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace KDDockWidgets;
+
+namespace {
+
+Display *x11Display()
+{
+    auto nativeInterface = qGuiApp->platformNativeInterface();
+    void *disp = nativeInterface->nativeResourceForIntegration(QByteArrayLiteral("display"));
+    return reinterpret_cast<Display *>(disp);
+}
+
+/// Walks the whole window tree, appending to @p result the windows in @p ours, by z-order
+void travelTree(::Window current, Display *disp, std::unordered_set<WId> &ours,
+                std::vector<WId> &result, int &numRoundTrips)
+{
+    if (ours.empty())
+        return;
+
+    ::Window parent, root, *children = nullptr;
+    unsigned int nchildren = 0;
+
+    numRoundTrips++;
+    if (!XQueryTree(disp, current, &root, &parent, &children, &nchildren))
+        return;
+
+    if (!children)
+        return;
+
+    for (unsigned int i = 0; i < nchildren; ++i) {
+        /// XQueryTree returns a lot more stuff than our top-level stuff, let's search for it:
+        if (ours.erase(children[i]) > 0)
+            result.push_back(children[i]);
+
+        // Recurs:
+        travelTree(children[i], disp, ours, result, numRoundTrips);
+    }
+
+    XFree(children);
+}
+
+}
+
+WindowZOrder &WindowZOrder::self()
+{
+    static WindowZOrder zorder;
+    return zorder;
+}
+
+WindowZOrder::WindowZOrder()
+{
+    qGuiApp->installNativeEventFilter(this);
+}
+
+WindowZOrder::~WindowZOrder()
+{
+    if (qGuiApp)
+        qGuiApp->removeNativeEventFilter(this);
+}
+
+void WindowZOrder::invalidate()
+{
+    m_valid = false;
+    m_rebuiltSinceInvalidation = false;
+}
+
+int WindowZOrder::numRoundTrips() const
+{
+    return m_numRoundTrips;
+}
+
+void WindowZOrder::rebuild()
+{
+    m_stackingOrder.clear();
+    m_valid = true;
+    m_rebuiltSinceInvalidation = true;
+
+    const Core::Window::List windows = DockRegistry::self()->topLevels();
+    if (windows.isEmpty())
+        return;
+
+    std::unordered_set<WId> ours;
+    ours.reserve(windows.size());
+    for (const Core::Window::Ptr &window : windows)
+        ours.insert(window->handle());
+
+    Display *disp = x11Display();
+    const ::Window rootWindow = DefaultRootWindow(disp);
+
+    if (m_stackingAtom == 0) {
+        m_numRoundTrips++;
+        m_stackingAtom = XInternAtom(disp, "_NET_CLIENT_LIST_STACKING", False);
+    }
+
+    // The window manager maintains the stacking order of all clients, bottom to top
+    Atom actualType = 0;
+    int actualFormat = 0;
+    unsigned long numItems = 0, bytesAfter = 0;
+    unsigned char *data = nullptr;
+    m_numRoundTrips++;
+    const int status = XGetWindowProperty(disp, rootWindow, m_stackingAtom, 0, ~0L, False,
+                                          XA_WINDOW, &actualType, &actualFormat, &numItems,
+                                          &bytesAfter, &data);
+    if (status == Success && data && actualType == XA_WINDOW && actualFormat == 32) {
+        // Format 32 properties are returned as an array of longs, even on 64-bit
+        auto clients = reinterpret_cast<const ::Window *>(data);
+        for (unsigned long i = 0; i < numItems; ++i) {
+            if (ours.erase(clients[i]) > 0)
+                m_stackingOrder.push_back(clients[i]);
+        }
+    }
+
+    if (data)
+        XFree(data);
+
+    if (!ours.empty()) {
+        // No window manager, or it doesn't support EWMH, or it doesn't list some of our windows.
+        // Walk the tree instead.
+        m_stackingOrder.clear();
+        for (const Core::Window::Ptr &window : windows)
+            ours.insert(window->handle());
+        travelTree(rootWindow, disp, ours, m_stackingOrder, m_numRoundTrips);
+    }
+}
+
+Core::Window::List WindowZOrder::orderedWindows(bool &ok)
+{
+    ok = true;
+    const Core::Window::List windows = DockRegistry::self()->topLevels();
+    if (windows.isEmpty())
+        return {};
+
+    if (!m_valid)
+        rebuild();
+
+    std::unordered_map<WId, Core::Window::Ptr> windowsByHandle;
+    windowsByHandle.reserve(windows.size());
+    for (const Core::Window::Ptr &window : windows)
+        windowsByHandle.emplace(window->handle(), window);
+
+    Core::Window::List orderedResult;
+    orderedResult.reserve(windows.size());
+    for (WId handle : m_stackingOrder) {
+        auto it = windowsByHandle.find(handle);
+        if (it != windowsByHandle.end()) {
+            orderedResult.push_back(it->second);
+            windowsByHandle.erase(it);
+        }
+    }
+
+    if (!windowsByHandle.empty() && !m_rebuiltSinceInvalidation) {
+        // A top-level appeared after the cache was built, for example the floating window we're
+        // dragging. Rebuild once, but not on every mouse move if XLib really can't see it.
+        invalidate();
+        return orderedWindows(ok);
+    }
+
+    ok = windowsByHandle.empty();
+    return orderedResult;
+}
+
+bool WindowZOrder::nativeEventFilter(const QByteArray &eventType, void *message,
+                                     Qt5Qt6Compat::qintptr *)
+{
+    if (eventType != "xcb_generic_event_t")
+        return false;
+
+    auto event = static_cast<xcb_generic_event_t *>(message);
+    switch (event->response_type & ~0x80) {
+    case XCB_CONFIGURE_NOTIFY: {
+        // Only restacking matters. Moves don't, and we get one per mouse move for the window
+        // being dragged.
+        auto ev = reinterpret_cast<xcb_configure_notify_event_t *>(event);
+        auto it = m_aboveSiblings.find(ev->window);
+        if (it == m_aboveSiblings.end()) {
+            m_aboveSiblings.emplace(ev->window, ev->above_sibling);
+            invalidate();
+        } else if (it->second != ev->above_sibling) {
+            it->second = ev->above_sibling;
+            invalidate();
+        }
+        break;
+    }
+    case XCB_DESTROY_NOTIFY:
+        m_aboveSiblings.erase(reinterpret_cast<xcb_destroy_notify_event_t *>(event)->window);
+        break;
+    case XCB_PROPERTY_NOTIFY: {
+        auto ev = reinterpret_cast<xcb_property_notify_event_t *>(event);
+        if (ev->atom == m_stackingAtom) {
+            KDDW_TRACE("WindowZOrder: Stacking order changed");
+            invalidate();
+        }
+        break;
+    }
+    default:
+        break;
+    }
+
+    return false;
+}
@@ -15,69 +15,66 @@
 
 #ifdef KDDockWidgets_XLIB
 
-#include "DockRegistry.h"
+#include "kddockwidgets/docks_export.h"
+#include "Qt5Qt6Compat_p.h"
 
-#include <QtGui/qpa/qplatformnativeinterface.h>
+#include <QAbstractNativeEventFilter>
 
-#include <X11/Xlib.h>
-#include <algorithm>
+#include <unordered_map>
+#include <vector>
 
 namespace KDDockWidgets {
 
-static void travelTree(WId current, Display *disp, Window::List &remaining, Window::List &result)
+/// @brief Caches the stacking order of our top-levels, so dragging doesn't query the X server
+/// on every mouse move.
+///
+/// The cache is rebuilt lazily after being invalidated, which happens when a drag starts, when
+/// one of our floating windows is exposed (see DockRegistry::onExposeEvent()) and when the X
+/// server tells us the stacking order changed (ConfigureNotify or a change to the root window's
+/// _NET_CLIENT_LIST_STACKING).
+/// Rebuilding reads _NET_CLIENT_LIST_STACKING, a single round-trip. If the window manager doesn't
+/// support it, we fall back to walking the window tree with XQueryTree.
+class DOCKS_EXPORT_FOR_UNIT_TESTS WindowZOrder : public QAbstractNativeEventFilter
 {
-    if (remaining.isEmpty())
-        return;
-
-    ::Window parent, root, *children;
-    unsigned int nchildren;
-
-    if (!XQueryTree(disp, current, &root, &parent, &children, &nchildren)) {
-        return;
-    }
-
-    if (!children)
-        return;
-
-    for (int i = 0; i < int(nchildren); ++i) {
-        /// XQueryTree returns a lot more stuff than our top-level stuff, let's search for it:
-        auto it =
-            std::find_if(remaining.begin(), remaining.end(), [i, children](Core::Window::Ptr window) {
-                return window->handle() == children[i];
-            });
-
-        if (it != remaining.end()) {
-            result.push_back(*it);
-            remaining.erase(it);
-        }
-
-        // Recurs:
-        travelTree(children[i], disp, remaining, result);
-    }
-}
+public:
+    static WindowZOrder &self();
 
-static Display *x11Display()
-{
-    auto nativeInterface = qGuiApp->platformNativeInterface();
-    void *disp = nativeInterface->nativeResourceForIntegration(QByteArrayLiteral("display"));
-    return reinterpret_cast<Display *>(disp);
-}
+    /// @brief Returns the KDDW top-level windows (MainWindow and floating widgets) ordered by
+    /// z-order. The front of the vector has stuff with lower Z
+    /// @p ok is set to false if some top-levels weren't seen by XLib
+    Core::Window::List orderedWindows(bool &ok);
+
+    /// @brief Discards the cache, the next call to orderedWindows() rebuilds it
+    void invalidate();
+
+    /// @brief Returns the number of X server round-trips done so far. For unit-tests.
+    int numRoundTrips() const;
+
+protected:
+    bool nativeEventFilter(const QByteArray &eventType, void *message,
+                           Qt5Qt6Compat::qintptr *result) override;
+
+private:
+    WindowZOrder();
+    ~WindowZOrder() override;
+    void rebuild();
+
+    /// Our top-level's handles, ordered by z-order, lowest first
+    std::vector<WId> m_stackingOrder;
+
+    /// The last known sibling below each window, so we can tell restacks from moves
+    std::unordered_map<uint32_t, uint32_t> m_aboveSiblings;
+    bool m_valid = false;
+    bool m_rebuiltSinceInvalidation = false;
+    int m_numRoundTrips = 0;
+    unsigned long m_stackingAtom = 0;
+};
 
 /// @brief returns the KDDW top-level windows (MainWindow and floating widgets) ordered by z-order
 /// The front of the vector has stuff with lower Z
-static Window::List orderedWindows(bool &ok)
+inline Core::Window::List orderedWindows(bool &ok)
 {
-    ok = true;
-    Window::List windows = DockRegistry::self()->topLevels();
-    if (windows.isEmpty())
-        return {};
-
-    Window::List orderedResult;
-    Display *disp = reinterpret_cast<Display *>(x11Display());
-    travelTree(DefaultRootWindow(disp), disp, /**by-ref*/ windows, /**by-ref*/ orderedResult);
-
-    ok = windows.isEmpty();
-    return orderedResult;
+    return WindowZOrder::self().orderedWindows(ok);
 }
 }
 
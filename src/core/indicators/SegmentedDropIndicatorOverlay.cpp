@@ -40,21 +40,32 @@ SegmentedDropIndicatorOverlay::SegmentedDropIndicatorOverlay(Core::DropArea *dro
 
 SegmentedDropIndicatorOverlay::~SegmentedDropIndicatorOverlay() = default;
 
+static const DropLocation s_outterLocations[] = { DropLocation_OutterLeft, DropLocation_OutterRight,
+                                                  DropLocation_OutterTop, DropLocation_OutterBottom };
+static const DropLocation s_innerLocations[] = { DropLocation_Left, DropLocation_Top, DropLocation_Right,
+                                                 DropLocation_Bottom, DropLocation_Center };
+
 DropLocation SegmentedDropIndicatorOverlay::hover_impl(Point pt)
 {
     m_hoveredPt = view()->mapFromGlobal(pt);
-    updateSegments();
+    const DropLocation previousLocation = currentDropLocation();
+    const bool segmentsChanged = updateSegments();
     setCurrentDropLocation(dropLocationForPos(m_hoveredPt));
 
+    // Moving the mouse within the same segment doesn't require a repaint
+    if (segmentsChanged || currentDropLocation() != previousLocation) {
+        m_numRepaintRequests++;
+        view()->update();
+    }
+
     return currentDropLocation();
 }
 
 DropLocation SegmentedDropIndicatorOverlay::dropLocationForPos(Point pos) const
 {
-    for (const auto &m_segment : m_segments) {
-        if (m_segment.second.containsPoint(pos, Qt::OddEvenFill)) {
-            return m_segment.first;
-        }
+    for (const Segment &segment : m_hitTestSegments) {
+        if (segment.boundingRect.contains(pos) && segment.polygon.containsPoint(pos, Qt::OddEvenFill))
+            return segment.location;
     }
 
     return DropLocation_None;
@@ -127,15 +138,31 @@ std::unordered_map<DropLocation, Polygon> SegmentedDropIndicatorOverlay::segment
              { DropLocation_OutterBottom, bottomPoints } };
 }
 
-void SegmentedDropIndicatorOverlay::updateSegments()
+bool SegmentedDropIndicatorOverlay::updateSegments()
 {
+    int visibleIndicators = 0;
+    for (auto indicator : s_outterLocations) {
+        if (dropIndicatorVisible(indicator))
+            visibleIndicators |= indicator;
+    }
+    for (auto indicator : s_innerLocations) {
+        if (dropIndicatorVisible(indicator))
+            visibleIndicators |= indicator;
+    }
+
+    if (visibleIndicators == m_segmentsVisibleIndicators && rect() == m_segmentsRect
+        && hoveredGroupRect() == m_segmentsHoveredGroupRect)
+        return false;
+
+    m_segmentsVisibleIndicators = visibleIndicators;
+    m_segmentsRect = rect();
+    m_segmentsHoveredGroupRect = hoveredGroupRect();
     m_segments.clear();
 
     const auto outterSegments = segmentsForRect(rect(), /*inner=*/false);
 
-    for (auto indicator : { DropLocation_OutterLeft, DropLocation_OutterRight,
-                            DropLocation_OutterTop, DropLocation_OutterBottom }) {
-        if (dropIndicatorVisible(indicator)) {
+    for (auto indicator : s_outterLocations) {
+        if (visibleIndicators & indicator) {
             auto it = outterSegments.find(indicator);
             const Polygon segment = it == outterSegments.cend() ? Polygon() : it->second;
             m_segments[indicator] = segment;
@@ -146,16 +173,20 @@ void SegmentedDropIndicatorOverlay::updateSegments()
     const bool useOffset = hasOutter;
     const auto innerSegments = segmentsForRect(hoveredGroupRect(), /*inner=*/true, useOffset);
 
-    for (auto indicator : { DropLocation_Left, DropLocation_Top, DropLocation_Right,
-                            DropLocation_Bottom, DropLocation_Center }) {
-        if (dropIndicatorVisible(indicator)) {
+    for (auto indicator : s_innerLocations) {
+        if (visibleIndicators & indicator) {
             auto it = innerSegments.find(indicator);
             const Polygon segment = it == innerSegments.cend() ? Polygon() : it->second;
             m_segments[indicator] = segment;
         }
     }
 
-    view()->update();
+    m_hitTestSegments.clear();
+    m_hitTestSegments.reserve(m_segments.size());
+    for (const auto &it : m_segments)
+        m_hitTestSegments.push_back({ it.first, it.second, it.second.boundingRect() });
+
+    return true;
 }
 
 Point SegmentedDropIndicatorOverlay::posForIndicator(DropLocation) const
@@ -173,3 +204,8 @@ const std::unordered_map<DropLocation, Polygon> &SegmentedDropIndicatorOverlay::
 {
     return m_segments;
 }
+
+int SegmentedDropIndicatorOverlay::numRepaintRequests() const
+{
+    return m_numRepaintRequests;
+}
@@ -15,6 +15,7 @@
 #include <kddockwidgets/core/DropIndicatorOverlay.h>
 
 #include <unordered_map>
+#include <vector>
 
 namespace KDDockWidgets {
 
@@ -32,6 +33,10 @@ public:
     Point hoveredPt() const;
     const std::unordered_map<DropLocation, Polygon> &segments() const;
 
+    /// @internal Just for the unit-tests.
+    /// Returns how many times hover() asked the view to repaint.
+    int numRepaintRequests() const;
+
     static int s_segmentGirth;
     static int s_segmentPenWidth;
     static int s_centralIndicatorMaxWidth;
@@ -42,10 +47,29 @@ protected:
     Point posForIndicator(DropLocation) const override;
 
 private:
+    struct Segment
+    {
+        DropLocation location;
+        Polygon polygon;
+        Rect boundingRect;
+    };
+
     std::unordered_map<DropLocation, Polygon> segmentsForRect(Rect, bool inner, bool useOffset = false) const;
-    void updateSegments();
+
+    /// Returns true if the segments changed
+    bool updateSegments();
+
     Point m_hoveredPt = {};
     std::unordered_map<DropLocation, Polygon> m_segments;
+
+    /// Same as m_segments, but flat and with bounding rects, as hit-testing happens on every mouse move
+    std::vector<Segment> m_hitTestSegments;
+
+    /// What the segments were calculated for. They're only recalculated if any of these change.
+    Rect m_segmentsRect;
+    Rect m_segmentsHoveredGroupRect;
+    int m_segmentsVisibleIndicators = -1;
+    int m_numRepaintRequests = 0;
 };
 
 }
@@ -48,6 +48,11 @@ using namespace KDDockWidgets::Core;
 int Core::Item::separatorThickness = 5;
 int Core::Item::layoutSpacing = 5;
 bool Core::Item::s_silenceSanityChecks = false;
+SanityCheckPolicy Core::Item::s_sanityCheckPolicy = SanityCheckPolicy::Full;
+int Core::Item::s_numCreated = 0;
+int Core::Item::s_sanityCheckSampleInterval = 10;
+static int s_numSanityViolations = 0;
+static int s_numSkippedLayoutChecks = 0;
 
 DumpScreenInfoFunc Core::Item::s_dumpScreenInfoFunc = nullptr;
 CreateSeparatorFunc Core::Item::s_createSeparatorFunc = nullptr;
@@ -58,6 +63,11 @@ Size Core::Item::hardcodedMaximumSize = Size(16777215, 16777215);
 
 bool Core::ItemBoxContainer::s_inhibitSimplify = false;
 LayoutingSeparator *LayoutingSeparator::s_separatorBeingDragged = nullptr;
+int LayoutingSeparator::s_numCreated = 0;
+
+namespace {
+uint64_t s_lastLayoutGeneration = 0;
+}
 
 inline bool locationIsVertical(Location loc)
 {
@@ -140,10 +150,7 @@ Rect Item::mapToRoot(Rect r) const
 
 Point Item::mapToRoot(Point p) const
 {
-    if (isRoot())
-        return p;
-
-    return p + parentContainer()->mapToRoot(pos());
+    return p + rootOrigin();
 }
 
 int Item::mapToRoot(int p, Qt::Orientation o) const
@@ -155,13 +162,7 @@ int Item::mapToRoot(int p, Qt::Orientation o) const
 
 Point Item::mapFromRoot(Point p) const
 {
-    const Item *it = this;
-    while (it) {
-        p = p - it->pos();
-        it = it->parentContainer();
-    }
-
-    return p;
+    return p - rootOrigin();
 }
 
 Rect Item::mapFromRoot(Rect r) const
@@ -186,11 +187,36 @@ int Item::mapFromRoot(int p, Qt::Orientation o) const
     return mapFromRoot(Point(p, 0)).x();
 }
 
+Point Item::rootOrigin() const
+{
+    if (!m_rootOriginValid) {
+        m_rootOrigin = m_parent ? m_parent->rootOrigin() + pos() : Point();
+        m_rootOriginValid = true;
+    }
+
+    return m_rootOrigin;
+}
+
+void Item::invalidateRootOrigin()
+{
+    // A valid origin implies a valid parent origin, so if we're already invalid then our
+    // descendants are too
+    if (!m_rootOriginValid)
+        return;
+
+    m_rootOriginValid = false;
+    if (auto c = asContainer()) {
+        for (Item *child : std::as_const(c->m_children))
+            child->invalidateRootOrigin();
+    }
+}
+
 void Item::setGuest(LayoutingGuest *guest)
 {
     assert(!guest || !m_guest);
 
     m_guest = guest;
+    setLayoutChanged(/*itemsAddedOrRemoved=*/true);
     m_parentChangedConnection.disconnect();
     m_guestDestroyedConnection->disconnect();
     m_layoutInvalidatedConnection->disconnect();
@@ -234,10 +260,52 @@ void Item::setGuest(LayoutingGuest *guest)
 void Item::updateWidgetGeometries()
 {
     if (m_guest) {
-        m_guest->setGeometry(mapToRoot(rect()));
+        if (LayoutTransaction::isActive(m_host)) {
+            addToTransaction(geometry());
+            m_guestGeometryPending = true;
+        } else {
+            m_guest->setGeometry(mapToRoot(rect()));
+        }
     }
 }
 
+void Item::addToTransaction(Rect oldGeometry)
+{
+    if (m_transactionIndex != -1)
+        return; // Already pending, keep the geometry it had when the transaction started
+
+    auto &pendingItems = m_host->m_transaction.pendingItems;
+    m_transactionIndex = int(pendingItems.size());
+    m_geometryBeforeTransaction = oldGeometry;
+    pendingItems.push_back(this);
+}
+
+void Item::commitTransaction()
+{
+    m_transactionIndex = -1;
+    emitGeometrySignals(m_geometryBeforeTransaction);
+
+    if (m_guestGeometryPending) {
+        m_guestGeometryPending = false;
+        if (m_guest)
+            m_guest->setGeometry(mapToRoot(rect()));
+    }
+}
+
+bool Item::hasPendingGeometry() const
+{
+    return m_transactionIndex != -1;
+}
+
+void Item::setLayoutChanged(bool itemsAddedOrRemoved)
+{
+    if (itemsAddedOrRemoved)
+        markSeparatorsDirty(/*structural=*/true);
+
+    if (m_host)
+        m_host->setLayoutChanged(itemsAddedOrRemoved);
+}
+
 void Item::to_json(nlohmann::json &json) const
 {
     json["sizingInfo"] = m_sizingInfo;
@@ -251,6 +319,7 @@ void Item::fillFromJson(const nlohmann::json &j,
                         const std::unordered_map<QString, LayoutingGuest *> &widgets)
 {
     m_sizingInfo = j.value("sizingInfo", SizingInfo());
+    invalidateRootOrigin();
     m_isVisible = j.value("isVisible", false);
     const QString guestId = j.value("guestId", QString());
     if (!guestId.isEmpty()) {
@@ -361,7 +430,14 @@ Vector<int> Item::pathFromRoot() const
 void Item::setHost(LayoutingHost *host)
 {
     if (m_host != host) {
+        if (m_transactionIndex != -1) {
+            // Pending in the old layout's transaction, which won't see us anymore. Apply it now.
+            m_host->m_transaction.pendingItems[size_t(m_transactionIndex)] = nullptr;
+            commitTransaction();
+        }
+
         m_host = host;
+        setLayoutChanged(/*itemsAddedOrRemoved=*/true);
         if (m_guest) {
             m_guest->setHost(host);
             m_guest->setVisible(true);
@@ -391,7 +467,10 @@ bool Item::isBeingInserted() const
 
 void Item::setBeingInserted(bool is)
 {
-    m_sizingInfo.isBeingInserted = is;
+    if (is != m_sizingInfo.isBeingInserted) {
+        m_sizingInfo.isBeingInserted = is;
+        markSeparatorsDirty(/*structural=*/false);
+    }
 
     // Trickle up the hierarchy too, as the parent might be hidden due to not having visible
     // children
@@ -426,6 +505,7 @@ void Item::setParentContainer(ItemContainer *parent)
     }
 
     m_parent = parent;
+    invalidateRootOrigin();
     connectParent(parent); // Reused by the ctor too
 
     setParent(parent);
@@ -507,6 +587,7 @@ void Item::setMinSize(Size sz)
 {
     if (sz != m_sizingInfo.minSize) {
         m_sizingInfo.minSize = sz;
+        setLayoutChanged();
         minSizeChanged.emit(this);
         if (!m_isSettingGuest)
             setSize_recursive(size().expandedTo(sz));
@@ -517,6 +598,7 @@ void Item::setMaxSizeHint(Size sz)
 {
     if (sz != m_sizingInfo.maxSizeHint) {
         m_sizingInfo.maxSizeHint = sz;
+        setLayoutChanged();
         maxSizeChanged.emit(this);
     }
 }
@@ -793,6 +875,8 @@ void Item::setIsVisible(bool is)
 {
     if (is != m_isVisible) {
         m_isVisible = is;
+        markSeparatorsDirty(/*structural=*/true);
+        setLayoutChanged();
         visibleChanged.emit(this, is);
     }
 
@@ -808,6 +892,43 @@ void Item::setGeometry_recursive(Rect rect)
     setGeometry(rect);
 }
 
+/*static*/
+bool Item::shouldCheckLayoutSanity()
+{
+    switch (s_sanityCheckPolicy) {
+    case SanityCheckPolicy::Full:
+        return true;
+    case SanityCheckPolicy::Off:
+        return false;
+    case SanityCheckPolicy::Sampled:
+        if (++s_numSkippedLayoutChecks >= s_sanityCheckSampleInterval) {
+            s_numSkippedLayoutChecks = 0;
+            return true;
+        }
+        return false;
+    }
+
+    return true;
+}
+
+/*static*/
+void Item::reportSanityViolation()
+{
+    ++s_numSanityViolations;
+}
+
+/*static*/
+int Item::numSanityViolations()
+{
+    return s_numSanityViolations;
+}
+
+/*static*/
+void Item::resetSanityViolations()
+{
+    s_numSanityViolations = 0;
+}
+
 bool Item::checkSanity()
 {
     if (!root())
@@ -838,7 +959,7 @@ bool Item::checkSanity()
         // Reminder: m_guest->geometry() is in the coordspace of the host widget (DropArea)
         // while Item::m_sizingInfo.geometry is in the coordspace of the parent container
 
-        if (m_guest->geometry() != mapToRoot(rect())) {
+        if (!m_guestGeometryPending && m_guest->geometry() != mapToRoot(rect())) {
             root()->dumpLayout();
             KDDW_ERROR("Guest widget doesn't have correct geometry. m_guest->guestGeometry={}, item.mapToRoot(rect())={}", m_guest->geometry(), mapToRoot(rect()));
             return false;
@@ -866,6 +987,10 @@ void Item::setGeometry(Rect rect)
         const Rect oldGeo = m_geometry;
 
         m_geometry = rect;
+        if (rect.topLeft() != oldGeo.topLeft())
+            invalidateRootOrigin();
+        markSeparatorsDirty(/*structural=*/false);
+        setLayoutChanged();
 
         if (rect.isEmpty()) {
             // Just a sanity check...
@@ -881,29 +1006,47 @@ void Item::setGeometry(Rect rect)
             }
         }
 
-        const Size minSz = minSize();
-        if (!s_silenceSanityChecks
-            && (rect.width() < minSz.width() || rect.height() < minSz.height())) {
-            if (auto r = root())
-                r->dumpLayout();
-            KDDW_ERROR("Constraints not honoured. this={}, sz={}, min={}, parent={}", ( void * )this, rect.size(), minSz, ( void * )parentContainer());
+        if (!s_silenceSanityChecks && s_sanityCheckPolicy != SanityCheckPolicy::Off) {
+            const Size minSz = minSize();
+            if (rect.width() < minSz.width() || rect.height() < minSz.height()) {
+                reportSanityViolation();
+                // Dumping is what's expensive, only do it when fully checking
+                if (s_sanityCheckPolicy == SanityCheckPolicy::Full) {
+                    if (auto r = root())
+                        r->dumpLayout();
+                }
+                KDDW_ERROR("Constraints not honoured. this={}, sz={}, min={}, parent={}", ( void * )this, rect.size(), minSz, ( void * )parentContainer());
+            }
         }
 
-        geometryChanged.emit();
-
-        if (oldGeo.x() != x())
-            xChanged.emit();
-        if (oldGeo.y() != y())
-            yChanged.emit();
-        if (oldGeo.width() != width())
-            widthChanged.emit();
-        if (oldGeo.height() != height())
-            heightChanged.emit();
+        if (LayoutTransaction::isActive(m_host)) {
+            // Signals are emitted once, when the transaction is committed
+            addToTransaction(oldGeo);
+        } else {
+            emitGeometrySignals(oldGeo);
+        }
 
         updateWidgetGeometries();
     }
 }
 
+void Item::emitGeometrySignals(Rect oldGeo)
+{
+    if (oldGeo == geometry())
+        return;
+
+    geometryChanged.emit();
+
+    if (oldGeo.x() != x())
+        xChanged.emit();
+    if (oldGeo.y() != y())
+        yChanged.emit();
+    if (oldGeo.width() != width())
+        widthChanged.emit();
+    if (oldGeo.height() != height())
+        heightChanged.emit();
+}
+
 void Item::dumpLayout(int level, bool)
 {
     std::string indent(LAYOUT_DUMP_INDENT * size_t(level), ' ');
@@ -939,6 +1082,7 @@ Item::Item(LayoutingHost *hostWidget, ItemContainer *parent)
     , m_parent(parent)
     , m_host(hostWidget)
 {
+    ++s_numCreated;
     connectParent(parent);
 }
 
@@ -948,6 +1092,7 @@ Item::Item(bool isContainer, LayoutingHost *hostWidget, ItemContainer *parent)
     , m_parent(parent)
     , m_host(hostWidget)
 {
+    ++s_numCreated;
     connectParent(parent);
 }
 
@@ -956,6 +1101,9 @@ Item::~Item()
     m_inDtor = true;
     aboutToBeDeleted.emit();
 
+    if (m_transactionIndex != -1)
+        m_host->m_transaction.pendingItems[size_t(m_transactionIndex)] = nullptr;
+
     m_minSizeChangedHandle.disconnect();
     m_visibleChangedHandle.disconnect();
     m_parentChangedConnection.disconnect();
@@ -976,6 +1124,7 @@ void Item::turnIntoPlaceholder()
 void Item::onGuestDestroyed()
 {
     m_guest = nullptr;
+    setLayoutChanged(/*itemsAddedOrRemoved=*/true);
     m_parentChangedConnection.disconnect();
     m_guestDestroyedConnection->disconnect();
 
@@ -1120,20 +1269,42 @@ struct ItemBoxContainer::Private
                                                      Qt::Orientation) const;
     void updateWidgets_recursive();
     /// Returns the positions that each separator should have (x position if Qt::Horizontal, y
-    /// otherwise)
-    Vector<int> requiredSeparatorPositions() const;
-    void updateSeparators();
+    /// otherwise). @p rootOffset is this container's position in root coordinates.
+    void requiredSeparatorPositions(Point rootOffset, Vector<int> &positions) const;
+    void updateSeparators(Point rootOffset, bool force);
     void deleteSeparators();
-    LayoutingSeparator *separatorAt(int p) const;
     Vector<double> childPercentages() const;
     bool isDummy() const;
     void deleteSeparators_recursive();
-    void updateSeparators_recursive();
+    /// Repositions the separators of this container and of its descendants.
+    /// Unless @p force, containers which didn't change since the last update are skipped.
+    void updateSeparators_recursive(bool force = false);
+    void updateSeparators_recursive(Point rootOffset, bool force);
+    void markSeparatorsDirty(bool structural);
     Size minSize(const Item::List &items) const;
     int excessLength() const;
 
+    class ScratchSizes;
+
+    /// SizingInfo lists for the sizing algorithms, reused between calls so they don't allocate
+    /// each time. More than one, as the algorithms can be reentered.
+    std::vector<SizingInfo::List> m_sizesPool;
+    /// Scratch buffers for calculateSqueezes()
+    mutable Vector<int> m_availabilities;
+    Vector<int> m_squeezes;
+
     mutable bool m_checkSanityScheduled = false;
     Vector<LayoutingSeparator *> m_separators;
+    /// Scratch buffer for requiredSeparatorPositions()
+    Vector<int> m_separatorPositions;
+    /// The separators need repositioning, as children changed geometry or visibility
+    bool m_separatorsDirty = true;
+    /// Some descendant container has dirty separators
+    bool m_childSeparatorsDirty = true;
+    /// The separators need raising, as new guests or separators might be above them
+    bool m_separatorsNeedRaise = true;
+    /// This container's position in root coordinates, when its separators were last updated
+    Point m_separatorsRootOffset;
     bool m_convertingItemToContainer = false;
     bool m_blockUpdatePercentages = false;
     bool m_isDeserializing = false;
@@ -1142,6 +1313,49 @@ struct ItemBoxContainer::Private
     ItemBoxContainer *const q;
 };
 
+/// Borrows a SizingInfo::List from the container's pool and gives it back, emptied but with
+/// its capacity, when going out of scope.
+class ItemBoxContainer::Private::ScratchSizes
+{
+public:
+    explicit ScratchSizes(ItemBoxContainer *container, bool ignoreBeingInserted = false)
+        : m_d(container->d)
+    {
+        if (!m_d->m_sizesPool.empty()) {
+            list = std::move(m_d->m_sizesPool.back());
+            m_d->m_sizesPool.pop_back();
+        }
+
+        container->fillSizes(list, ignoreBeingInserted);
+    }
+
+    ~ScratchSizes()
+    {
+        list.clear();
+        m_d->m_sizesPool.push_back(std::move(list));
+    }
+
+    SizingInfo::List list;
+
+private:
+    Private *const m_d;
+    KDDW_DELETE_COPY_CTOR(ScratchSizes)
+};
+
+void Item::markSeparatorsDirty(bool structural)
+{
+    if (m_inDtor)
+        return;
+
+    if (m_isContainer) {
+        if (auto c = asBoxContainer())
+            c->d->markSeparatorsDirty(structural);
+    }
+
+    if (auto p = parentBoxContainer())
+        p->d->markSeparatorsDirty(structural);
+}
+
 ItemBoxContainer::ItemBoxContainer(LayoutingHost *hostWidget, ItemContainer *parent)
     : ItemContainer(hostWidget, parent)
     , d(new Private(this))
@@ -1297,7 +1511,7 @@ bool ItemBoxContainer::checkSanity()
 
         if (!percentagesAreSane()) {
             // Percentages might be broken due to buggy old layouts. Try to fix them:
-            const_cast<ItemBoxContainer *>(this)->d->updateSeparators_recursive();
+            const_cast<ItemBoxContainer *>(this)->d->updateSeparators_recursive(/*force=*/true);
             if (!percentagesAreSane())
                 return false;
         }
@@ -1379,9 +1593,13 @@ bool ItemBoxContainer::checkSanity()
 void ItemBoxContainer::Private::scheduleCheckSanity() const
 {
 #ifdef KDDW_FRONTEND_QT
-    if (!m_checkSanityScheduled) {
+    if (!m_checkSanityScheduled && Item::shouldCheckLayoutSanity()) {
         m_checkSanityScheduled = true;
-        QTimer::singleShot(0, q->root(), &ItemBoxContainer::checkSanity);
+        ItemBoxContainer *root = q->root();
+        QTimer::singleShot(0, root, [root] {
+            if (!root->checkSanity())
+                Item::reportSanityViolation();
+        });
     }
 #endif
 }
@@ -1393,8 +1611,17 @@ bool ItemBoxContainer::hasOrientation() const
 
 int ItemBoxContainer::indexOfVisibleChild(const Item *item) const
 {
-    const Item::List items = visibleChildren();
-    return items.indexOf(const_cast<Item *>(item));
+    int index = 0;
+    for (Item *child : std::as_const(m_children)) {
+        if (!child->isVisible() || child->isBeingInserted())
+            continue;
+
+        if (child == item)
+            return index;
+        ++index;
+    }
+
+    return -1;
 }
 
 void ItemBoxContainer::restore(Item *child)
@@ -1428,6 +1655,7 @@ void ItemBoxContainer::removeItem(Item *item, bool hardRemove)
     if (hardRemove) {
         m_children.removeOne(item);
         delete item;
+        setLayoutChanged(/*itemsAddedOrRemoved=*/true);
         if (!isContainer)
             root()->numItemsChanged.emit();
     } else {
@@ -1456,6 +1684,7 @@ void ItemBoxContainer::removeItem(Item *item, bool hardRemove)
     } else {
         // Neighbours will occupy the space of the deleted item
         growNeighbours(side1Item, side2Item);
+        setLayoutChanged();
         itemsChanged.emit();
 
         updateSizeConstraints();
@@ -1491,6 +1720,7 @@ ItemBoxContainer *ItemBoxContainer::convertChildToContainer(Item *leaf, const In
         option.visibility = InitialVisibilityOption::StartHidden;
 
     container->insertItem(leaf, Location_OnTop, option);
+    setLayoutChanged(/*itemsAddedOrRemoved=*/true);
     itemsChanged.emit();
     d->updateSeparators_recursive();
 
@@ -1786,7 +2016,8 @@ Rect ItemBoxContainer::suggestedDropRectFallback(const Item *item, const Item *r
 
 void ItemBoxContainer::positionItems()
 {
-    SizingInfo::List sizes = this->sizes();
+    Private::ScratchSizes scratch(this);
+    SizingInfo::List &sizes = scratch.list;
     positionItems(/*by-ref=*/sizes);
     applyPositions(sizes);
 
@@ -1806,12 +2037,13 @@ void ItemBoxContainer::positionItems_recursive()
 
 void ItemBoxContainer::applyPositions(const SizingInfo::List &sizes)
 {
-    const Item::List items = visibleChildren();
-    const auto count = items.size();
-    assert(count == sizes.size());
-    for (int i = 0; i < count; ++i) {
-        Item *item = items.at(i);
-        const SizingInfo &sizing = sizes[i];
+    int i = 0;
+    for (Item *item : std::as_const(m_children)) {
+        if (!item->isVisible() || item->isBeingInserted())
+            continue;
+
+        assert(i < sizes.size());
+        const SizingInfo &sizing = sizes[i++];
         if (sizing.isBeingInserted) {
             continue;
         }
@@ -1863,6 +2095,7 @@ void ItemBoxContainer::clear()
     }
     m_children.clear();
     d->deleteSeparators();
+    setLayoutChanged(/*itemsAddedOrRemoved=*/true);
 }
 
 Item *ItemBoxContainer::itemAt(Point p) const
@@ -1896,7 +2129,7 @@ void ItemBoxContainer::setHost(LayoutingHost *host)
         item->setHost(host);
     }
 
-    d->updateSeparators_recursive();
+    d->updateSeparators_recursive(/*force=*/true);
 }
 
 void ItemBoxContainer::setIsVisible(bool)
@@ -1954,6 +2187,7 @@ void ItemBoxContainer::insertItem(Item *item, int index, const InitialOption &op
     m_children.insert(index, item);
     item->setParentContainer(this);
 
+    setLayoutChanged(/*itemsAddedOrRemoved=*/true);
     itemsChanged.emit();
 
     if (!d->m_convertingItemToContainer && item->isVisible()) {
@@ -2006,7 +2240,7 @@ void ItemBoxContainer::setOrientation(Qt::Orientation o)
 {
     if (o != d->m_orientation) {
         d->m_orientation = o;
-        d->updateSeparators_recursive();
+        d->updateSeparators_recursive(/*force=*/true);
     }
 }
 
@@ -2286,8 +2520,11 @@ void ItemBoxContainer::setSize_recursive(Size newSize, ChildrenResizeStrategy st
 
     const Size minSize = this->minSize();
     if (newSize.width() < minSize.width() || newSize.height() < minSize.height()) {
-        if (!s_silenceSanityChecks && hostSupportsHonouringLayoutMinSize()) {
-            root()->dumpLayout();
+        if (!s_silenceSanityChecks && s_sanityCheckPolicy != SanityCheckPolicy::Off
+            && hostSupportsHonouringLayoutMinSize()) {
+            reportSanityViolation();
+            if (s_sanityCheckPolicy == SanityCheckPolicy::Full)
+                root()->dumpLayout();
             KDDW_ERROR("New size doesn't respect size constraints new={}, min={}, this={}", newSize, minSize, ( void * )this);
         }
         return;
@@ -2299,9 +2536,9 @@ void ItemBoxContainer::setSize_recursive(Size newSize, ChildrenResizeStrategy st
     const Size oldSize = size();
     setSize(newSize);
 
-    const Item::List children = visibleChildren();
-    const auto count = children.size();
-    SizingInfo::List childSizes = sizes();
+    Private::ScratchSizes scratch(this);
+    SizingInfo::List &childSizes = scratch.list;
+    const auto count = childSizes.size();
 
     // #1 Since we changed size, also resize out children.
     // But apply them to our SizingInfo::List first before setting actual Item/QWidget geometries
@@ -2384,6 +2621,7 @@ void ItemBoxContainer::updateChildPercentages()
     if (root()->d->m_blockUpdatePercentages)
         return;
 
+    setLayoutChanged();
     const int usable = usableLength();
     for (Item *item : std::as_const(m_children)) {
         if (item->isVisible() && !item->isBeingInserted()) {
@@ -2654,7 +2892,8 @@ void ItemBoxContainer::requestEqualSize(LayoutingSeparator *separator)
 
 void ItemBoxContainer::layoutEqually()
 {
-    SizingInfo::List childSizes = sizes();
+    Private::ScratchSizes scratch(this);
+    SizingInfo::List &childSizes = scratch.list;
     if (!childSizes.isEmpty()) {
         layoutEqually(childSizes);
         applyGeometries(childSizes);
@@ -2970,7 +3209,8 @@ void ItemBoxContainer::growNeighbours(Item *side1Neighbour, Item *side2Neighbour
     if (!side1Neighbour && !side2Neighbour)
         return;
 
-    SizingInfo::List childSizes = sizes();
+    Private::ScratchSizes scratch(this);
+    SizingInfo::List &childSizes = scratch.list;
 
     if (side1Neighbour && side2Neighbour) {
         const int index1 = indexOfVisibleChild(side1Neighbour);
@@ -3147,9 +3387,9 @@ void ItemBoxContainer::growItem(Item *item, int amount, GrowthStrategy growthStr
                                 bool accountForNewSeparator,
                                 ChildrenResizeStrategy childResizeStrategy)
 {
-    const Item::List items = visibleChildren();
-    const auto index = items.indexOf(item);
-    SizingInfo::List sizes = this->sizes();
+    const auto index = indexOfVisibleChild(item);
+    Private::ScratchSizes scratch(this);
+    SizingInfo::List &sizes = scratch.list;
 
     growItem(index, /*by-ref=*/sizes, amount, growthStrategy, neighbourSqueezeStrategy,
              accountForNewSeparator);
@@ -3160,24 +3400,36 @@ void ItemBoxContainer::growItem(Item *item, int amount, GrowthStrategy growthStr
 void ItemBoxContainer::applyGeometries(const SizingInfo::List &sizes,
                                        ChildrenResizeStrategy strategy)
 {
-    const Item::List items = visibleChildren();
-    const auto count = items.size();
-    assert(count == sizes.size());
+    int i = 0;
+    for (Item *item : std::as_const(m_children)) {
+        if (!item->isVisible() || item->isBeingInserted())
+            continue;
 
-    for (int i = 0; i < count; ++i) {
-        Item *item = items.at(i);
-        item->setSize_recursive(sizes[i].geometry.size(), strategy);
+        assert(i < sizes.size());
+        item->setSize_recursive(sizes[i++].geometry.size(), strategy);
     }
 
+    assert(i == sizes.size());
     positionItems();
 }
 
 SizingInfo::List ItemBoxContainer::sizes(bool ignoreBeingInserted) const
 {
-    const Item::List children = visibleChildren(ignoreBeingInserted);
     SizingInfo::List result;
-    result.reserve(children.count());
-    for (Item *item : children) {
+    fillSizes(result, ignoreBeingInserted);
+    return result;
+}
+
+void ItemBoxContainer::fillSizes(SizingInfo::List &result, bool ignoreBeingInserted) const
+{
+    // Same filter as visibleChildren(), without the temporary list
+    result.clear();
+    for (Item *item : std::as_const(m_children)) {
+        const bool include = ignoreBeingInserted ? (item->isVisible() || item->isBeingInserted())
+                                                 : (item->isVisible() && !item->isBeingInserted());
+        if (!include)
+            continue;
+
         if (item->isContainer()) {
             // Containers have virtual min/maxSize methods, and don't really fill in these
             // properties So fill them here
@@ -3186,23 +3438,21 @@ SizingInfo::List ItemBoxContainer::sizes(bool ignoreBeingInserted) const
         }
         result.push_back(item->m_sizingInfo);
     }
-
-    return result;
 }
 
-Vector<int> ItemBoxContainer::calculateSqueezes(
+void ItemBoxContainer::calculateSqueezes(
     SizingInfo::List::const_iterator begin, // clazy:exclude=function-args-by-ref
     SizingInfo::List::const_iterator end, int needed, // clazy:exclude=function-args-by-ref
-    NeighbourSqueezeStrategy strategy, bool reversed) const
+    NeighbourSqueezeStrategy strategy, Vector<int> &squeezes, bool reversed) const
 {
-    Vector<int> availabilities;
+    Vector<int> &availabilities = d->m_availabilities;
+    availabilities.clear();
     for (auto it = begin; it < end; ++it) {
         availabilities.push_back(it->availableLength(d->m_orientation));
     }
 
     const auto count = availabilities.count();
 
-    Vector<int> squeezes;
     squeezes.resize(count);
     std::fill(squeezes.begin(), squeezes.end(), 0);
 
@@ -3216,7 +3466,8 @@ Vector<int> ItemBoxContainer::calculateSqueezes(
             if (numDonors == 0) {
                 root()->dumpLayout();
                 assert(false);
-                return {};
+                squeezes.clear();
+                return;
             }
 
             int toTake = missing / numDonors;
@@ -3255,8 +3506,6 @@ Vector<int> ItemBoxContainer::calculateSqueezes(
         // Doesn't really happen
         KDDW_ERROR("Missing is negative. missing={}, squeezes={}", missing, squeezes);
     }
-
-    return squeezes;
 }
 
 void ItemBoxContainer::shrinkNeighbours(int index, SizingInfo::List &sizes, int side1Amount,
@@ -3269,8 +3518,8 @@ void ItemBoxContainer::shrinkNeighbours(int index, SizingInfo::List &sizes, int
         auto begin = sizes.cbegin();
         auto end = sizes.cbegin() + index;
         const bool reversed = strategy == NeighbourSqueezeStrategy::ImmediateNeighboursFirst;
-        const Vector<int> squeezes =
-            calculateSqueezes(begin, end, side1Amount, strategy, reversed);
+        Vector<int> &squeezes = d->m_squeezes;
+        calculateSqueezes(begin, end, side1Amount, strategy, squeezes, reversed);
         for (int i = 0; i < squeezes.size(); ++i) {
             const int squeeze = squeezes.at(i);
             SizingInfo &sizing = sizes[i];
@@ -3284,7 +3533,8 @@ void ItemBoxContainer::shrinkNeighbours(int index, SizingInfo::List &sizes, int
         auto begin = sizes.cbegin() + index + 1;
         auto end = sizes.cend();
 
-        const Vector<int> squeezes = calculateSqueezes(begin, end, side2Amount, strategy);
+        Vector<int> &squeezes = d->m_squeezes;
+        calculateSqueezes(begin, end, side2Amount, strategy, squeezes);
         for (int i = 0; i < squeezes.size(); ++i) {
             const int squeeze = squeezes.at(i);
             SizingInfo &sizing = sizes[i + index + 1];
@@ -3293,73 +3543,88 @@ void ItemBoxContainer::shrinkNeighbours(int index, SizingInfo::List &sizes, int
     }
 }
 
-Vector<int> ItemBoxContainer::Private::requiredSeparatorPositions() const
+void ItemBoxContainer::Private::requiredSeparatorPositions(Point rootOffset,
+                                                           Vector<int> &positions) const
 {
     const int numSeparators = std::max(0, q->numVisibleChildren() - 1);
-    Vector<int> positions;
+    positions.clear();
     positions.reserve(numSeparators);
 
+    const int offset = Core::pos(rootOffset, m_orientation);
     for (Item *item : std::as_const(q->m_children)) {
         if (positions.size() == numSeparators)
             break;
 
         if (item->isVisible()) {
             const int localPos = item->m_sizingInfo.edge(m_orientation) + 1;
-            positions.push_back(q->mapToRoot(localPos, m_orientation));
+            positions.push_back(localPos + offset);
         }
     }
-
-    return positions;
 }
 
-void ItemBoxContainer::Private::updateSeparators()
+void ItemBoxContainer::Private::updateSeparators(Point rootOffset, bool force)
 {
-    if (!q->host())
-        return;
-
-    const Vector<int> positions = requiredSeparatorPositions();
+    // Borrow the scratch buffer, in case we're reentered
+    Vector<int> positions = std::move(m_separatorPositions);
+    requiredSeparatorPositions(rootOffset, positions);
     const auto requiredNumSeparators = positions.size();
 
+    bool needsRaise = force || m_separatorsNeedRaise;
     const bool numSeparatorsChanged = requiredNumSeparators != m_separators.size();
     if (numSeparatorsChanged) {
         // Instead of just creating N missing ones at the end of the list, let's minimize separators
-        // having their position changed, to minimize flicker
-        LayoutingSeparator::List newSeparators;
-        newSeparators.reserve(requiredNumSeparators);
-
-        for (int position : positions) {
-            LayoutingSeparator *separator = separatorAt(position);
-            if (separator) {
+        // having their position changed, to minimize flicker.
+        // Both lists are sorted by position, so a single pass finds the ones to reuse.
+        const LayoutingSeparator::List oldSeparators = std::exchange(m_separators, {});
+        m_separators.reserve(requiredNumSeparators);
+
+        int oldIndex = 0;
+        for (int position : std::as_const(positions)) {
+            // Separators before this position won't be reused
+            while (oldIndex < oldSeparators.size() && oldSeparators.at(oldIndex)->position() < position)
+                oldSeparators.at(oldIndex++)->free();
+
+            if (oldIndex < oldSeparators.size() && oldSeparators.at(oldIndex)->position() == position) {
                 // Already existing, reuse
-                newSeparators.push_back(separator);
-                m_separators.removeOne(separator);
+                m_separators.push_back(oldSeparators.at(oldIndex++));
             } else {
-                separator = s_createSeparatorFunc(q->host(), m_orientation, q);
-                newSeparators.push_back(separator);
+                m_separators.push_back(s_createSeparatorFunc(q->host(), m_orientation, q));
+                needsRaise = true;
             }
         }
 
         // delete what remained, which is unused
-        deleteSeparators();
-
-        m_separators = newSeparators;
+        while (oldIndex < oldSeparators.size())
+            oldSeparators.at(oldIndex++)->free();
     }
 
     // Update their positions:
-    const int pos2 =
-        q->isVertical() ? q->mapToRoot(Point(0, 0)).x() : q->mapToRoot(Point(0, 0)).y();
+    const int pos2 = Core::pos(rootOffset, oppositeOrientation(m_orientation));
+    const int length = q->oppositeLength();
 
     int i = 0;
-    for (int position : positions) {
-        m_separators.at(i)->setGeometry(position, pos2, q->oppositeLength());
+    for (int position : std::as_const(positions)) {
+        m_separators.at(i)->setGeometry(position, pos2, length);
         i++;
     }
 
     // raise separators as they might be overlapping with dockwidget (supported use case)
-    for (auto sep : std::as_const(m_separators))
-        sep->raise();
+    // Only needed when guests or separators were added, as that's what changes the z-order.
+    if (needsRaise) {
+        for (auto sep : std::as_const(m_separators))
+            sep->raise();
+    }
+
+    // Merely moving doesn't change the percentages. If they're currently blocked, stay dirty so
+    // they're updated next time.
+    if (force || m_separatorsDirty) {
+        q->updateChildPercentages();
+        m_separatorsDirty = q->root()->d->m_blockUpdatePercentages;
+    }
 
-    q->updateChildPercentages();
+    m_separatorsNeedRaise = false;
+    m_separatorsRootOffset = rootOffset;
+    m_separatorPositions = std::move(positions);
 }
 
 void ItemBoxContainer::Private::deleteSeparators()
@@ -3380,15 +3645,54 @@ void ItemBoxContainer::Private::deleteSeparators_recursive()
     }
 }
 
-void ItemBoxContainer::Private::updateSeparators_recursive()
+void ItemBoxContainer::Private::updateSeparators_recursive(bool force)
 {
-    updateSeparators();
+    if (!q->host())
+        return;
+
+    updateSeparators_recursive(q->mapToRoot(Point(0, 0)), force);
+}
+
+void ItemBoxContainer::Private::updateSeparators_recursive(Point rootOffset, bool force)
+{
+    // If this container moved then all its separators, and the ones of its descendants, moved
+    const bool moved = rootOffset != m_separatorsRootOffset;
+    if (force || moved || m_separatorsDirty || m_separatorsNeedRaise)
+        updateSeparators(rootOffset, force);
+    else if (!m_childSeparatorsDirty)
+        return;
+
+    m_childSeparatorsDirty = false;
 
     // recurse into the children:
-    const Item::List items = q->visibleChildren();
-    for (Item *item : items) {
-        if (auto c = item->asBoxContainer())
-            c->d->updateSeparators_recursive();
+    for (Item *item : std::as_const(q->m_children)) {
+        if (!item->isVisible() || item->isBeingInserted())
+            continue;
+
+        if (auto c = item->asBoxContainer()) {
+            c->d->updateSeparators_recursive(rootOffset + c->pos(), force);
+            if (c->d->m_separatorsDirty || c->d->m_childSeparatorsDirty)
+                m_childSeparatorsDirty = true;
+        }
+    }
+}
+
+void ItemBoxContainer::Private::markSeparatorsDirty(bool structural)
+{
+    m_separatorsDirty = true;
+    if (structural)
+        m_separatorsNeedRaise = true;
+
+    for (ItemBoxContainer *c = q->parentBoxContainer(); c; c = c->parentBoxContainer()) {
+        if (!structural && c->d->m_childSeparatorsDirty)
+            break; // Ancestors were already flagged
+
+        c->d->m_childSeparatorsDirty = true;
+        if (structural) {
+            // The number of visible children might have changed up the hierarchy
+            c->d->m_separatorsDirty = true;
+            c->d->m_separatorsNeedRaise = true;
+        }
     }
 }
 
@@ -3404,6 +3708,7 @@ void ItemBoxContainer::simplify()
     // layouts inside. It can simply have the contents of said sub-layouts
 
     ScopedValueRollback isInSimplify(d->m_isSimplifying, true);
+    setLayoutChanged(/*itemsAddedOrRemoved=*/true);
 
     Item::List newChildren;
     newChildren.reserve(m_children.size() + 20); // over-reserve a bit
@@ -3438,16 +3743,6 @@ void ItemBoxContainer::simplify()
     }
 }
 
-LayoutingSeparator *ItemBoxContainer::Private::separatorAt(int p) const
-{
-    for (auto separator : m_separators) {
-        if (separator->position() == p)
-            return separator;
-    }
-
-    return nullptr;
-}
-
 bool ItemBoxContainer::isVertical() const
 {
     return d->m_orientation == Qt::Vertical;
@@ -3563,9 +3858,10 @@ void ItemBoxContainer::fillFromJson(const nlohmann::json &j,
     }
 
     if (isRoot()) {
+        setLayoutChanged(/*itemsAddedOrRemoved=*/true);
         updateChildPercentages_recursive();
         if (host()) {
-            d->updateSeparators_recursive();
+            d->updateSeparators_recursive(/*force=*/true);
             d->updateWidgets_recursive();
         }
 
@@ -3574,8 +3870,10 @@ void ItemBoxContainer::fillFromJson(const nlohmann::json &j,
 
         minSizeChanged.emit(this);
 #ifdef DOCKS_DEVELOPER_MODE
-        if (!checkSanity())
+        if (shouldCheckLayoutSanity() && !checkSanity()) {
+            reportSanityViolation();
             KDDW_ERROR("Resulting layout is invalid");
+        }
 #endif
     }
 }
@@ -4164,7 +4462,20 @@ bool ItemContainer::inSetSize() const
     });
 }
 
+LayoutingHost::LayoutingHost()
+    : m_generation(++s_lastLayoutGeneration)
+    , m_structureGeneration(m_generation)
+{
+}
+
 LayoutingHost::~LayoutingHost() = default;
+
+void LayoutingHost::setLayoutChanged(bool itemsAddedOrRemoved)
+{
+    m_generation = ++s_lastLayoutGeneration;
+    if (itemsAddedOrRemoved)
+        m_structureGeneration = m_generation;
+}
 LayoutingSeparator::~LayoutingSeparator() = default;
 
 LayoutingSeparator::LayoutingSeparator(LayoutingHost *host, Qt::Orientation orientation, Core::ItemBoxContainer *container)
@@ -4172,6 +4483,7 @@ LayoutingSeparator::LayoutingSeparator(LayoutingHost *host, Qt::Orientation orie
     , m_orientation(orientation)
     , m_parentContainer(container)
 {
+    ++s_numCreated;
 }
 
 bool LayoutingSeparator::isVertical() const
@@ -4254,8 +4566,10 @@ int LayoutingSeparator::onMouseMove(Point pos, bool moveSeparator)
         return -1;
     }
 
-    if (moveSeparator)
+    if (moveSeparator) {
+        LayoutTransaction transaction(m_host);
         m_parentContainer->requestSeparatorMove(this, positionToGoTo - position());
+    }
 
     return positionToGoTo;
 }
@@ -4342,6 +4656,43 @@ void LayoutingHost::insertItemRelativeTo(Core::LayoutingGuest *guest, Core::Layo
         box->insertItemRelativeTo(guest->layoutItem(), relativeTo->layoutItem(), loc, initialOption);
 }
 
+LayoutTransaction::LayoutTransaction(LayoutingHost *host)
+    : m_host(host)
+{
+    if (m_host)
+        m_host->m_transaction.depth++;
+}
+
+LayoutTransaction::~LayoutTransaction()
+{
+    if (!m_host)
+        return;
+
+    auto &state = m_host->m_transaction;
+    state.depth--;
+    if (state.depth > 0 || state.isCommitting)
+        return;
+
+    // While committing, geometry changes done by signal handlers are applied immediately.
+    // Signal handlers might also delete items, which nulls their entry, hence iterating by index.
+    ScopedValueRollback guard(state.isCommitting, true);
+    for (size_t i = 0; i < state.pendingItems.size(); ++i) {
+        if (Item *item = state.pendingItems[i])
+            item->commitTransaction();
+    }
+
+    state.pendingItems.clear();
+}
+
+bool LayoutTransaction::isActive(const LayoutingHost *host)
+{
+    if (!host)
+        return false;
+
+    const auto &state = host->m_transaction;
+    return state.depth > 0 && !state.isCommitting;
+}
+
 #ifdef Q_CC_MSVC
 #pragma warning(pop)
 #endif
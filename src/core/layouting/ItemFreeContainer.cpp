@@ -45,6 +45,7 @@ void ItemFreeContainer::addDockWidget(Item *item, Point localPt)
     item->setParentContainer(this);
     item->setPos(localPt);
 
+    setLayoutChanged(/*itemsAddedOrRemoved=*/true);
     itemsChanged.emit();
 
     if (item->isVisible())
@@ -57,6 +58,7 @@ void ItemFreeContainer::clear()
 {
     deleteAll(m_children);
     m_children.clear();
+    setLayoutChanged(/*itemsAddedOrRemoved=*/true);
 }
 
 void ItemFreeContainer::removeItem(Item *item, bool hardRemove)
@@ -74,6 +76,7 @@ void ItemFreeContainer::removeItem(Item *item, bool hardRemove)
     if (wasVisible)
         numVisibleItemsChanged.emit(numVisibleChildren());
 
+    setLayoutChanged(/*itemsAddedOrRemoved=*/true);
     itemsChanged.emit();
 }
 
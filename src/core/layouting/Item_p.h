@@ -284,6 +284,23 @@ public:
 
     static bool s_silenceSanityChecks;
 
+    /// See Config::setSanityCheckPolicy()
+    static SanityCheckPolicy s_sanityCheckPolicy;
+    static int s_sanityCheckSampleInterval;
+
+    /// Returns whether a full layout check, which visits the whole tree, should run now.
+    /// Always true with SanityCheckPolicy::Full, 1 in s_sanityCheckSampleInterval calls
+    /// with Sampled, never with Off.
+    static bool shouldCheckLayoutSanity();
+
+    /// Counts a sanity check failure. See Config::numSanityCheckViolations()
+    static void reportSanityViolation();
+    static int numSanityViolations();
+    static void resetSanityViolations();
+
+    /// Number of Items created so far, containers included. See LayoutSaver::RestoreProfile
+    static int s_numCreated;
+
     Item *outermostNeighbor(Location, bool visibleOnly = true) const;
     Item *outermostNeighbor(Side, Qt::Orientation, bool visibleOnly) const;
 
@@ -339,6 +356,10 @@ public:
     bool isBeingInserted() const;
     void setBeingInserted(bool);
 
+    /// Returns whether this item has geometry changes which weren't delivered yet, due
+    /// to a LayoutTransaction being active
+    bool hasPendingGeometry() const;
+
     SizingInfo m_sizingInfo;
     const bool m_isContainer;
     ItemContainer *m_parent = nullptr;
@@ -351,10 +372,30 @@ private:
     friend class ItemContainer;
     friend class ItemBoxContainer;
     friend class ItemFreeContainer;
+    friend struct LayoutTransaction;
     int m_refCount = 0;
     void onGuestDestroyed();
+    void emitGeometrySignals(Rect oldGeometry);
+    void setLayoutChanged(bool itemsAddedOrRemoved = false);
+    /// Marks the separators around this item for repositioning by the next
+    /// updateSeparators_recursive(). @p structural is for when the number of visible items might
+    /// have changed, which affects the ancestors too.
+    void markSeparatorsDirty(bool structural);
+    /// Returns this item's top-left in root coordinates. It's cached, as walking up a deeply
+    /// nested layout for every mapToRoot() and mapFromRoot() call adds up.
+    Point rootOrigin() const;
+    /// Invalidates the cached root origin, of this item and of its descendants.
+    /// Called when this item moves or is reparented. Recalculated on demand.
+    void invalidateRootOrigin();
+    void addToTransaction(Rect oldGeometry);
+    void commitTransaction();
+    int m_transactionIndex = -1;
+    bool m_guestGeometryPending = false;
+    Rect m_geometryBeforeTransaction;
     bool m_isVisible = false;
     bool m_inSetSize = false;
+    mutable bool m_rootOriginValid = false;
+    mutable Point m_rootOrigin;
     LayoutingHost *m_host = nullptr;
     LayoutingGuest *m_guest = nullptr;
     static DumpScreenInfoFunc s_dumpScreenInfoFunc;
@@ -408,6 +449,7 @@ protected:
     Item::List m_children;
 
 private:
+    friend class Item;
     struct Private;
     Private *const d;
 };
@@ -533,9 +575,14 @@ private:
     void onChildVisibleChanged(Item *child, bool visible) override;
     void updateSizeConstraints();
     SizingInfo::List sizes(bool ignoreBeingInserted = false) const;
-    Vector<int> calculateSqueezes(SizingInfo::List::const_iterator begin,
-                                  SizingInfo::List::const_iterator end, int needed,
-                                  NeighbourSqueezeStrategy, bool reversed = false) const;
+    /// Like sizes(), but fills @p result, reusing its capacity
+    void fillSizes(SizingInfo::List &result, bool ignoreBeingInserted = false) const;
+    /// Fills @p squeezes with how much each item in [begin, end) needs to shrink, so that
+    /// they shrink by @p needed in total
+    void calculateSqueezes(SizingInfo::List::const_iterator begin,
+                           SizingInfo::List::const_iterator end, int needed,
+                           NeighbourSqueezeStrategy, Vector<int> &squeezes,
+                           bool reversed = false) const;
     Rect suggestedDropRectFallback(const Item *item, const Item *relativeTo,
                                    KDDockWidgets::Location) const;
     Item *itemAt(Point p) const;
@@ -624,6 +671,25 @@ struct AtomicSanityChecks
     KDDW_DELETE_COPY_CTOR(AtomicSanityChecks)
 };
 
+/// Batches geometry changes done to the Items of @p host's layout while it's alive.
+/// Items still update their geometry immediately, but the guests only receive their final
+/// geometry, once, when the outermost transaction ends. The same for the geometry signals.
+/// Without it, a setSize_recursive() on a deep tree would move each guest widget several times.
+/// Other layouts aren't affected.
+struct DOCKS_EXPORT LayoutTransaction
+{
+    explicit LayoutTransaction(LayoutingHost *host);
+    ~LayoutTransaction();
+
+    /// Returns whether there's a transaction in progress in @p host's layout
+    static bool isActive(const LayoutingHost *host);
+
+    KDDW_DELETE_COPY_CTOR(LayoutTransaction)
+
+private:
+    LayoutingHost *const m_host;
+};
+
 DOCKS_EXPORT void from_json(const nlohmann::json &, SizingInfo &);
 DOCKS_EXPORT void to_json(nlohmann::json &, const SizingInfo &);
 DOCKS_EXPORT void to_json(nlohmann::json &, Item *);
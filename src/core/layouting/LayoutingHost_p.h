@@ -14,12 +14,16 @@
 #include "kddockwidgets/docks_export.h"
 #include "kddockwidgets/KDDockWidgets.h"
 
+#include <cstdint>
+#include <vector>
+
 namespace KDDockWidgets {
 
 namespace Core {
 
 class LayoutingGuest;
 class ItemContainer;
+class Item;
 
 /// The interface graphical components need to implement in order to host a layout
 /// The layout engine doesn't know about any GUI, only about LayoutingHost.
@@ -33,7 +37,7 @@ class ItemContainer;
 class DOCKS_EXPORT LayoutingHost
 {
 public:
-    LayoutingHost() = default;
+    LayoutingHost();
     virtual ~LayoutingHost();
 
     /// Weather this layout host supports min size constraints or not
@@ -45,9 +49,43 @@ public:
     void insertItemRelativeTo(Core::LayoutingGuest *guest, Core::LayoutingGuest *relativeTo, Location loc,
                               const InitialOption &initialOption = {});
 
+    /// Returns a number which changes whenever anything in the layout changes, be it an item's
+    /// geometry, visibility or the items themselves. Allows for cheap dirty checking.
+    /// Numbers are never reused, not even by other hosts.
+    uint64_t generation() const
+    {
+        return m_generation;
+    }
+
+    /// Like generation(), but only changes when items are added or removed, or when an item
+    /// gets a different guest. Which is when their index in the layout changes.
+    uint64_t structureGeneration() const
+    {
+        return m_structureGeneration;
+    }
+
+    /// Called by the layouting engine whenever the layout changes
+    void setLayoutChanged(bool itemsAddedOrRemoved = false);
+
     Core::ItemContainer *m_rootItem = nullptr;
 
 private:
+    friend class Item;
+    friend struct LayoutTransaction;
+
+    uint64_t m_generation = 0;
+    uint64_t m_structureGeneration = 0;
+
+    /// State of this layout's LayoutTransaction, if any
+    struct TransactionState
+    {
+        int depth = 0;
+        bool isCommitting = false;
+        // Items whose guest and signals are pending. Deleted items leave a nullptr behind.
+        std::vector<Item *> pendingItems;
+    };
+    TransactionState m_transaction;
+
     LayoutingHost(const LayoutingHost &) = delete;
     LayoutingHost &operator=(const LayoutingHost &) = delete;
 };
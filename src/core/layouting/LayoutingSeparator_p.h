@@ -53,6 +53,9 @@ public:
 
     static LayoutingSeparator *s_separatorBeingDragged;
 
+    /// Number of separators created so far. See LayoutSaver::RestoreProfile
+    static int s_numCreated;
+
 private:
     int offset() const;
     LayoutingSeparator(const LayoutingSeparator &) = delete;
@@ -280,6 +280,8 @@ void View::raise()
     } else {
         m_parentView->raiseChild(this);
     }
+
+    d->raised.emit();
 }
 
 bool View::isRootView() const
@@ -28,7 +28,7 @@ StateDraggingWayland::~StateDraggingWayland()
 
 void StateDraggingWayland::onEntry()
 {
-    KDDW_DEBUG("StateDraggingWayland entered");
+    KDDW_DEBUG_CAT(DRAG, "StateDraggingWayland entered");
 
     if (DragController::instance()->m_inQDrag) {
         // Maybe we can exit the state due to the nested event loop of QDrag::Exec();
@@ -46,9 +46,9 @@ void StateDraggingWayland::onEntry()
     drag.setPixmap(q->m_windowBeingDragged->pixmap());
 
     Platform::instance()->installGlobalEventFilter(q);
-    KDDW_DEBUG("Started QDrag");
+    KDDW_DEBUG_CAT(DRAG, "Started QDrag");
     const Qt::DropAction result = drag.exec();
-    KDDW_DEBUG("QDrag finished with result={}", int(result));
+    KDDW_DEBUG_CAT(DRAG, "QDrag finished with result={}", int(result));
 
     Platform::instance()->removeGlobalEventFilter(q);
     if (result == Qt::IgnoreAction)
@@ -57,7 +57,7 @@ void StateDraggingWayland::onEntry()
 
 bool StateDraggingWayland::handleMouseButtonRelease(QPoint /*globalPos*/)
 {
-    KDDW_DEBUG(Q_FUNC_INFO);
+    KDDW_DEBUG_CAT(DRAG, Q_FUNC_INFO);
     q->dragCanceled.emit();
     return true;
 }
@@ -90,14 +90,14 @@ bool StateDraggingWayland::handleDragEnter(DragMoveEvent *ev, DropArea *dropArea
 
 bool StateDraggingWayland::handleDragLeave(DropArea *dropArea)
 {
-    KDDW_DEBUG(Q_FUNC_INFO);
+    KDDW_DEBUG_CAT(DRAG, Q_FUNC_INFO);
     dropArea->removeHover();
     return true;
 }
 
 bool StateDraggingWayland::handleDrop(DropEvent *ev, DropArea *dropArea)
 {
-    KDDW_DEBUG(Q_FUNC_INFO);
+    KDDW_DEBUG_CAT(DRAG, Q_FUNC_INFO);
     auto mimeData = object_cast<const WaylandMimeData *>(ev->mimeData());
     if (!mimeData || !q->m_windowBeingDragged)
         return false; // Not for us, some other user drag.
@@ -117,11 +117,11 @@ bool StateDraggingWayland::handleDrop(DropEvent *ev, DropArea *dropArea)
 
 bool StateDraggingWayland::handleDragMove(DragMoveEvent *ev, DropArea *dropArea)
 {
-    KDDW_DEBUG("StateDraggingWayland::handleDragMove");
+    KDDW_DEBUG_CAT(DRAG, "StateDraggingWayland::handleDragMove");
 
     auto mimeData = object_cast<const WaylandMimeData *>(ev->mimeData());
     if (!mimeData || !q->m_windowBeingDragged) {
-        KDDW_DEBUG("StateDraggingWayland::handleDragMove. Early bailout hasMimeData={} windowBeingDragged={}", mimeData != nullptr, bool(q->m_windowBeingDragged));
+        KDDW_DEBUG_CAT(DRAG, "StateDraggingWayland::handleDragMove. Early bailout hasMimeData={} windowBeingDragged={}", mimeData != nullptr, bool(q->m_windowBeingDragged));
         return false; // Not for us, some other user drag.
     }
 
@@ -11,12 +11,37 @@
 
 #include "ViewWrapper_p.h"
 #include "core/View_p.h"
+#include "core/Controller_p.h"
 
 #include <QDebug>
+#include <QObject>
+
+#include <unordered_map>
 
 using namespace KDDockWidgets;
 using namespace KDDockWidgets::QtCommon;
 
+namespace {
+
+struct CachedWrapper
+{
+    /// Lives as long as the QObject, so walking up the view tree doesn't allocate.
+    /// Its event filter is cheap, as wrappers don't usually have view event filters.
+    ViewWrapper::Ptr wrapper;
+    QMetaObject::Connection objectDestroyedConnection;
+    KDBindings::ScopedConnection controllerDeletedConnection;
+};
+
+/// Wrappers by the QObject they wrap. Intentionally leaked, as it must outlive any QObject
+/// destroyed during static destruction.
+std::unordered_map<QObject *, CachedWrapper> &wrapperCache()
+{
+    static auto cache = new std::unordered_map<QObject *, CachedWrapper>();
+    return *cache;
+}
+
+}
+
 
 ViewWrapper::ViewWrapper(Core::Controller *controller, QObject *thisObj)
     : View_qt(controller, Core::ViewType::ViewWrapper, thisObj)
@@ -173,6 +198,50 @@ void ViewWrapper::setMouseTracking(bool)
     qFatal("Not implemented");
 }
 
+/*static*/
+ViewWrapper::Ptr ViewWrapper::cachedWrapper(QObject *obj, Factory factory)
+{
+    if (!obj)
+        return {};
+
+    auto &cache = wrapperCache();
+    auto it = cache.find(obj);
+    if (it != cache.end() && it->second.wrapper)
+        return it->second.wrapper;
+
+    auto wrapper = factory(obj);
+    Ptr sharedptr(wrapper);
+    wrapper->d->m_thisWeakPtr = sharedptr;
+
+    if (wrapper->m_ownsController && dynamic_cast<View_qt *>(obj)) {
+        // One of our views, but its controller wasn't found. Can happen while it's being
+        // constructed. Don't cache it, so the next lookup finds the right controller.
+        return sharedptr;
+    }
+
+    CachedWrapper &entry = cache[obj];
+    entry.wrapper = sharedptr;
+
+    if (!entry.objectDestroyedConnection) {
+        entry.objectDestroyedConnection = QObject::connect(obj, &QObject::destroyed, [obj] {
+            wrapperCache().erase(obj);
+        });
+    }
+
+    if (!wrapper->m_ownsController) {
+        // The wrapper would dangle once the controller is gone.
+        // Only drop it, disconnecting from inside the emit isn't safe.
+        entry.controllerDeletedConnection = wrapper->controller()->dptr()->aboutToBeDeleted.connect([obj] {
+            auto &c = wrapperCache();
+            auto cached = c.find(obj);
+            if (cached != c.end())
+                cached->second.wrapper.reset();
+        });
+    }
+
+    return entry.wrapper;
+}
+
 std::shared_ptr<Core::View> ViewWrapper::asWrapper()
 {
     if (auto sharedptr = d->m_thisWeakPtr.lock())
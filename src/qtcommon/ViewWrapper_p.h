@@ -61,6 +61,14 @@ public:
     void setMouseTracking(bool) override;
     std::shared_ptr<View> asWrapper() override;
 
+protected:
+    using Factory = ViewWrapper *(*)(QObject *);
+
+    /// Returns the wrapper for @p obj, creating it with @p factory if there isn't one yet.
+    /// A wrapper stays cached until its QObject is destroyed, or until its controller is, if it
+    /// has a real one. So walking up the view tree only allocates the first time.
+    static Ptr cachedWrapper(QObject *obj, Factory factory);
+
 private:
     Q_DISABLE_COPY(ViewWrapper)
     const bool m_ownsController;
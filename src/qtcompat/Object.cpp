@@ -24,6 +24,7 @@ Object::~Object()
     if (m_parent)
         m_parent->removeChild(this);
 
+    m_weakRefs.invalidate();
     aboutToBeDeleted.emit();
 
     const auto children = m_children;
@@ -18,6 +18,7 @@
 #include "kddockwidgets/docks_export.h"
 #include "enums_p.h"
 #include "string_p.h"
+#include "core/WeakRef_p.h"
 
 #include <vector>
 
@@ -43,6 +44,12 @@ public:
 
     KDBindings::Signal<> aboutToBeDeleted;
 
+    /// For ObjectGuard. Returns a ref'ed control block, or nullptr if we're being destroyed.
+    WeakRefControlBlock *acquireWeakRef() const
+    {
+        return m_weakRefs.acquire();
+    }
+
 private:
     void removeChild(Object *child);
     void addChild(Object *child);
@@ -50,6 +57,7 @@ private:
     Object *m_parent = nullptr;
     std::vector<Object *> m_children;
     QString m_name;
+    WeakRefTracker m_weakRefs;
 };
 
 }
@@ -182,7 +182,7 @@ void Group::startMDIResize()
             /// Doesn't happen, but let's be vigilant
             KDDW_ERROR("Group::startMDIResize: Handler is already enabled!");
         } else {
-            handler->setEnabled(true);
+            handler->startEventFiltering();
         }
     } else {
         KDDW_ERROR("Group::startMDIResize: No WidgetResizeHandler found. isMDI={}", isMDI());
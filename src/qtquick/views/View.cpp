@@ -592,6 +592,8 @@ void View::raise()
         if (last != this)
             stackAfter(last);
     }
+
+    d->raised.emit();
 }
 
 /*static*/ bool View::isRootView(const QQuickItem *item)
@@ -459,12 +459,7 @@ std::shared_ptr<Core::View> ViewWrapper::create(QObject *item)
 /*static*/
 std::shared_ptr<Core::View> ViewWrapper::create(QQuickItem *item)
 {
-    if (!item)
-        return {};
-
-    auto wrapper = new ViewWrapper(item);
-    auto sharedptr = std::shared_ptr<View>(wrapper);
-    wrapper->d->m_thisWeakPtr = sharedptr;
-
-    return sharedptr;
+    return cachedWrapper(item, [](QObject *obj) -> QtCommon::ViewWrapper * {
+        return new ViewWrapper(static_cast<QQuickItem *>(obj));
+    });
 }
@@ -46,11 +46,11 @@ void SegmentedDropIndicatorOverlay::drawSegments(QPainter *p)
            DropLocation_OutterRight, DropLocation_OutterBottom }) {
         auto it = segments.find(loc);
         const Polygon segment = it == segments.cend() ? Polygon() : it->second;
-        drawSegment(p, segment);
+        drawSegment(p, segment, loc == m_controller->currentDropLocation());
     }
 }
 
-void SegmentedDropIndicatorOverlay::drawSegment(QPainter *p, const QPolygon &segment)
+void SegmentedDropIndicatorOverlay::drawSegment(QPainter *p, const QPolygon &segment, bool isHovered)
 {
     if (segment.isEmpty())
         return;
@@ -60,7 +60,9 @@ void SegmentedDropIndicatorOverlay::drawSegment(QPainter *p, const QPolygon &seg
     p->setPen(pen);
     QColor brush(SegmentedDropIndicatorOverlay::s_segmentBrushColor);
 
-    if (segment.containsPoint(m_controller->hoveredPt(), Qt::OddEvenFill))
+    // The controller only asks for a repaint when the hovered segment changes, so don't use
+    // hoveredPt() here
+    if (isHovered)
         brush = SegmentedDropIndicatorOverlay::s_hoveredSegmentBrushColor;
 
     p->setBrush(brush);
@@ -41,7 +41,7 @@ protected:
 
 private:
     void drawSegments(QPainter *p);
-    void drawSegment(QPainter *p, const QPolygon &segment);
+    void drawSegment(QPainter *p, const QPolygon &segment, bool isHovered);
     Core::SegmentedDropIndicatorOverlay *const m_controller;
 };
 
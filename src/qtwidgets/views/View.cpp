@@ -120,6 +120,13 @@ void View<T>::setMinimumSize(QSize sz)
 }
 
 
+template<class T>
+void View<T>::raise()
+{
+    Base::raise();
+    d->raised.emit();
+}
+
 template<class T>
 std::shared_ptr<Core::View> View<T>::childViewAt(QPoint localPos) const
 {
@@ -226,10 +226,7 @@ public:
         Base::activateWindow();
     }
 
-    void raise() override
-    {
-        Base::raise();
-    }
+    void raise() override;
 
     bool isRootView() const override
     {
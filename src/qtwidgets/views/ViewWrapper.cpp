@@ -113,14 +113,9 @@ std::shared_ptr<Core::View> ViewWrapper::create(QObject *widget)
 /*static*/
 std::shared_ptr<Core::View> ViewWrapper::create(QWidget *widget)
 {
-    if (!widget)
-        return {};
-
-    auto wrapper = new ViewWrapper(widget);
-    auto sharedptr = std::shared_ptr<View>(wrapper);
-    wrapper->d->m_thisWeakPtr = sharedptr;
-
-    return sharedptr;
+    return cachedWrapper(widget, [](QObject *obj) -> QtCommon::ViewWrapper * {
+        return new ViewWrapper(static_cast<QWidget *>(obj));
+    });
 }
 
 ViewWrapper::ViewWrapper(QObject *widget)
@@ -0,0 +1,371 @@
+/*
+  This file is part of KDDockWidgets.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+/// Headless benchmarks for the layouting engine (Core::Item and friends).
+/// Uses dummy LayoutingHost/LayoutingGuest/LayoutingSeparator implementations, so no
+/// frontend is involved and we're only measuring the engine itself.
+///
+/// Usage: bench_layouting [--smoke] [--sizes=10,100,1000] [--depths=10,20]
+///
+/// Reports ns/op and heap allocations/op. --smoke runs only the small trees and fails if
+/// the resulting layouts aren't sane, it's what ctest runs.
+/// --depths is for the "deep" benchmarks, which nest each item one level deeper than the
+/// previous one. For those, the items column is the nesting depth.
+
+#define KDDW_TESTS_COUNT_ALLOCATIONS
+#include "../utils_headless.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace KDDockWidgets;
+using namespace KDDockWidgets::Core;
+using namespace KDDockWidgets::Tests;
+
+namespace {
+
+constexpr int s_guestMinLength = 20;
+constexpr int s_cellLength = 100;
+
+// Query results are written here, so the compiler can't optimize the queries away
+volatile int s_sink = 0;
+
+/// A layout with N items, arranged as a grid: The root is horizontal, and each column
+/// is a vertical container. Square by default, pass @p columns == @p numItems for a
+/// single wide row.
+struct Fixture
+{
+    explicit Fixture(int numItems, int columns = 0)
+        : numColumns(columns > 0 ? columns
+                                 : std::max(1, int(std::ceil(std::sqrt(double(numItems))))))
+    {
+        root.reset(new ItemBoxContainer(&host));
+        host.m_rootItem = root.get();
+        const int numRows = (numItems + numColumns - 1) / numColumns;
+        root->setSize({ numColumns * s_cellLength, numRows * s_cellLength });
+
+        for (int i = 0; i < numItems; ++i) {
+            guests.push_back(std::make_unique<DummyGuest>(QString::number(i)));
+            auto item = new Item(&host);
+            item->setGuest(guests.back().get());
+            items.push_back(item);
+        }
+    }
+
+    ~Fixture()
+    {
+        // Items go first, guests hold weak references to them
+        root.reset();
+    }
+
+    void insertItem(int index)
+    {
+        Item *item = items[size_t(index)];
+        const int column = index % numColumns;
+        if (index < numColumns) {
+            root->insertItem(item, Location_OnRight);
+        } else {
+            ItemBoxContainer::insertItemRelativeTo(item, items[size_t(column)], Location_OnBottom);
+        }
+    }
+
+    void populate()
+    {
+        for (int i = 0, end = int(items.size()); i < end; ++i)
+            insertItem(i);
+    }
+
+    DummyHost host;
+    const int numColumns;
+    std::unique_ptr<ItemBoxContainer> root;
+    std::vector<std::unique_ptr<DummyGuest>> guests;
+    std::vector<Item *> items;
+};
+
+/// A layout where each item is nested one level deeper than the previous one, alternating
+/// horizontal and vertical containers. Like a spiral of docks.
+struct DeepFixture
+{
+    explicit DeepFixture(int depth)
+    {
+        root.reset(new ItemBoxContainer(&host));
+        host.m_rootItem = root.get();
+        root->setSize({ (depth + 1) * s_cellLength, (depth + 1) * s_cellLength });
+
+        for (int i = 0; i <= depth; ++i) {
+            guests.push_back(std::make_unique<DummyGuest>(QString::number(i)));
+            auto item = new Item(&host);
+            item->setGuest(guests.back().get());
+            if (items.empty()) {
+                root->insertItem(item, Location_OnRight);
+            } else {
+                ItemBoxContainer::insertItemRelativeTo(
+                    item, items.back(), i % 2 == 0 ? Location_OnRight : Location_OnBottom);
+            }
+            items.push_back(item);
+        }
+    }
+
+    ~DeepFixture()
+    {
+        root.reset();
+    }
+
+    /// Returns the innermost item
+    Item *deepest() const
+    {
+        return items.back();
+    }
+
+    DummyHost host;
+    std::unique_ptr<ItemBoxContainer> root;
+    std::vector<std::unique_ptr<DummyGuest>> guests;
+    std::vector<Item *> items;
+};
+
+bool checkSanity(Fixture &fixture, const char *benchmarkName)
+{
+    if (!fixture.root->checkSanity()) {
+        std::fprintf(stderr, "Layout isn't sane after %s with %d items\n", benchmarkName,
+                     int(fixture.items.size()));
+        return false;
+    }
+
+    return true;
+}
+
+/// Returns a separator of the root container, which is moved back and forth.
+LayoutingSeparator *middleSeparator(Fixture &fixture)
+{
+    const auto separators = fixture.root->separators();
+    return separators.isEmpty() ? nullptr : separators.at(separators.size() / 2);
+}
+
+bool runBenchmarks(Benchmark &bench, int numItems)
+{
+    bool ok = true;
+
+    {
+        // insertItem: Populates an empty layout
+        std::unique_ptr<Fixture> fixture;
+        bench.run(
+            "insertItem", numItems, [&] { fixture = std::make_unique<Fixture>(numItems); },
+            [&] {
+                fixture->populate();
+                return uint64_t(numItems);
+            });
+        ok = ok && checkSanity(*fixture, "insertItem");
+    }
+
+    {
+        // removeItem: Empties a populated layout
+        std::unique_ptr<Fixture> fixture;
+        bench.run(
+            "removeItem", numItems,
+            [&] {
+                fixture = std::make_unique<Fixture>(numItems);
+                fixture->populate();
+            },
+            [&] {
+                // Remove from the end, the column heads go last
+                for (auto it = fixture->items.rbegin(); it != fixture->items.rend(); ++it)
+                    fixture->root->removeItem(*it);
+                fixture->items.clear();
+                return uint64_t(numItems);
+            });
+        ok = ok && checkSanity(*fixture, "removeItem");
+    }
+
+    Fixture fixture(numItems);
+    fixture.populate();
+    const Size originalSize = fixture.root->size();
+
+    {
+        // setSize_recursive: Resizes the window, like the user dragging the window border
+        int i = 0;
+        bench.run("setSize_recursive", numItems, {}, [&] {
+            const int delta = (++i % 2) == 0 ? 0 : 50;
+            fixture.root->setSize_recursive(originalSize + Size(delta, delta));
+            return uint64_t(1);
+        });
+        fixture.root->setSize_recursive(originalSize);
+        ok = ok && checkSanity(fixture, "setSize_recursive");
+    }
+
+    {
+        // Same, but guests only get their final geometry, like Layout::setLayoutSize() does
+        int i = 0;
+        bench.run("setSize_recursive+transaction", numItems, {}, [&] {
+            const int delta = (++i % 2) == 0 ? 0 : 50;
+            LayoutTransaction transaction(fixture.root->host());
+            fixture.root->setSize_recursive(originalSize + Size(delta, delta));
+            return uint64_t(1);
+        });
+        fixture.root->setSize_recursive(originalSize);
+        ok = ok && checkSanity(fixture, "setSize_recursive+transaction");
+    }
+
+    if (LayoutingSeparator *separator = middleSeparator(fixture)) {
+        // requestSeparatorMove: Moves a separator back and forth, like the user dragging it
+        int i = 0;
+        bench.run("requestSeparatorMove", numItems, {}, [&] {
+            const int delta = (++i % 2) == 0 ? -10 : 10;
+            const int min = fixture.root->minPosForSeparator_global(separator);
+            const int max = fixture.root->maxPosForSeparator_global(separator);
+            const int pos = separator->position();
+            const int newPos = std::max(min, std::min(pos + delta, max));
+            fixture.root->requestSeparatorMove(separator, newPos - pos);
+            return uint64_t(1);
+        });
+        ok = ok && checkSanity(fixture, "requestSeparatorMove");
+    }
+
+    {
+        bench.run("layoutEqually_recursive", numItems, {}, [&] {
+            fixture.root->layoutEqually_recursive();
+            return uint64_t(1);
+        });
+        ok = ok && checkSanity(fixture, "layoutEqually_recursive");
+    }
+
+    // Same, but with all items as children of the root. Stresses the per-container sizing
+    // algorithms, which are linear on the number of children.
+    Fixture wide(numItems, /*columns=*/numItems);
+    wide.populate();
+
+    if (LayoutingSeparator *separator = middleSeparator(wide)) {
+        int i = 0;
+        bench.run("wide requestSeparatorMove", numItems, {}, [&] {
+            const int delta = (++i % 2) == 0 ? -10 : 10;
+            const int min = wide.root->minPosForSeparator_global(separator);
+            const int max = wide.root->maxPosForSeparator_global(separator);
+            const int pos = separator->position();
+            const int newPos = std::max(min, std::min(pos + delta, max));
+            wide.root->requestSeparatorMove(separator, newPos - pos);
+            return uint64_t(1);
+        });
+        ok = ok && checkSanity(wide, "wide requestSeparatorMove");
+    }
+
+    {
+        bench.run("wide layoutEqually", numItems, {}, [&] {
+            wide.root->layoutEqually();
+            return uint64_t(1);
+        });
+        ok = ok && checkSanity(wide, "wide layoutEqually");
+    }
+
+    return ok;
+}
+
+/// Global coordinate queries on the innermost item of a deeply nested layout.
+/// They shouldn't depend on the depth, as long as nothing moved in between.
+bool runDeepBenchmarks(Benchmark &bench, int depth)
+{
+    DeepFixture fixture(depth);
+    if (!fixture.root->checkSanity()) {
+        std::fprintf(stderr, "Layout isn't sane after nesting %d levels\n", depth);
+        return false;
+    }
+
+    Item *deepest = fixture.deepest();
+    constexpr int numQueries = 1000;
+
+    {
+        bench.run("deep mapToRoot", depth, {}, [&] {
+            for (int i = 0; i < numQueries; ++i)
+                s_sink = deepest->mapToRoot(Point(i, i)).x();
+            return uint64_t(numQueries);
+        });
+    }
+
+    {
+        bench.run("deep mapFromRoot", depth, {}, [&] {
+            for (int i = 0; i < numQueries; ++i)
+                s_sink = deepest->mapFromRoot(Point(i, i)).x();
+            return uint64_t(numQueries);
+        });
+    }
+
+    return true;
+}
+
+std::vector<int> parseSizes(const char *str)
+{
+    std::vector<int> sizes;
+    std::string s(str);
+    size_t start = 0;
+    while (start < s.size()) {
+        const size_t end = s.find(',', start);
+        const int size = std::atoi(s.substr(start, end - start).c_str());
+        if (size > 0)
+            sizes.push_back(size);
+        if (end == std::string::npos)
+            break;
+        start = end + 1;
+    }
+
+    return sizes;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    bool smoke = false;
+    std::vector<int> sizes;
+    std::vector<int> depths;
+
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        if (std::strcmp(arg, "--smoke") == 0) {
+            smoke = true;
+        } else if (std::strncmp(arg, "--sizes=", 8) == 0) {
+            sizes = parseSizes(arg + 8);
+        } else if (std::strncmp(arg, "--depths=", 9) == 0) {
+            depths = parseSizes(arg + 9);
+        } else {
+            std::fprintf(stderr, "Usage: %s [--smoke] [--sizes=10,100,1000] [--depths=10,20]\n",
+                         argv[0]);
+            return 1;
+        }
+    }
+
+    if (sizes.empty())
+        sizes = smoke ? std::vector<int> { 10, 100 } : std::vector<int> { 10, 100, 1000, 5000 };
+
+    if (depths.empty())
+        depths = smoke ? std::vector<int> { 12 } : std::vector<int> { 10, 15, 20 };
+
+    Item::setCreateSeparatorFunc([](LayoutingHost *host, Qt::Orientation o,
+                                    ItemBoxContainer *container) -> LayoutingSeparator * {
+        return new DummySeparator(host, o, container);
+    });
+
+    // So that big layouts fit in a reasonable root size
+    Item::hardcodedMinimumSize = Size(s_guestMinLength, s_guestMinLength);
+
+    Benchmark bench(smoke, "items");
+    bench.printHeader();
+
+    bool ok = true;
+    for (int numItems : sizes)
+        ok = runBenchmarks(bench, numItems) && ok;
+
+    for (int depth : depths)
+        ok = runDeepBenchmarks(bench, depth) && ok;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+/*
+  This file is part of KDDockWidgets.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+/// Compares ObjectGuard, which uses an intrusive weak reference, against a guard which
+/// connects to aboutToBeDeleted, which is what ObjectGuard used to do.
+///
+/// Each op guards an object, copies the guard (like scheduling a DelayedDelete or a
+/// DelayedEmitFocusChanged does) and then destroys the object, which must null both guards.
+/// Items are used as guarded objects, as they don't need a frontend.
+///
+/// Usage: bench_objectguard [--smoke]
+///
+/// Reports ns/op and heap allocations/op.
+
+#define KDDW_TESTS_COUNT_ALLOCATIONS
+#include "../utils_headless.h"
+#include "core/ObjectGuard_p.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace KDDockWidgets;
+using namespace KDDockWidgets::Core;
+using namespace KDDockWidgets::Tests;
+
+namespace {
+
+/// What ObjectGuard used to be: A connection per guard, copying connects again
+template<typename T>
+class ConnectionGuard
+{
+public:
+    explicit ConnectionGuard(T *o)
+    {
+        setObject(o);
+    }
+
+    ConnectionGuard(const ConnectionGuard &other)
+    {
+        setObject(other.obj);
+    }
+
+    T *data() const
+    {
+        return obj;
+    }
+
+private:
+    void setObject(T *o)
+    {
+        obj = o;
+        if (auto object = dynamic_cast<Core::Object *>(o))
+            conn = object->Object::aboutToBeDeleted.connect([this] { obj = nullptr; });
+    }
+
+    T *obj = nullptr;
+    KDBindings::ScopedConnection conn;
+};
+
+/// Guards @p objects with Guard, copies each guard, deletes the objects and checks that all
+/// guards became null. Returns the number of objects, or 0 on failure.
+template<typename Guard>
+uint64_t guardAndDelete(std::vector<Item *> &objects)
+{
+    // Reserved upfront, so guards are never moved. ConnectionGuard's connection captures this.
+    std::vector<Guard> guards;
+    guards.reserve(objects.size() * 2);
+
+    for (Item *object : objects) {
+        guards.emplace_back(object);
+        const Guard &original = guards.back();
+        guards.emplace_back(original);
+    }
+
+    for (Item *object : objects)
+        delete object;
+    objects.clear();
+
+    for (const Guard &guard : guards) {
+        if (guard.data()) {
+            std::fprintf(stderr, "Guards weren't nulled\n");
+            return 0;
+        }
+    }
+
+    return guards.size() / 2;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    bool smoke = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--smoke") == 0) {
+            smoke = true;
+        } else {
+            std::fprintf(stderr, "Usage: %s [--smoke]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    DummyHost host;
+    std::vector<Item *> objects;
+
+    Benchmark bench(smoke, "objects");
+    bench.printHeader();
+
+    bool ok = true;
+    for (int numObjects : { 100, 1000 }) {
+        auto setup = [&] {
+            for (int i = 0; i < numObjects; ++i)
+                objects.push_back(new Item(&host));
+        };
+
+        ok = bench.run("connection guard", numObjects, setup,
+                       [&] { return guardAndDelete<ConnectionGuard<Item>>(objects); })
+            && ok;
+        ok = bench.run("ObjectGuard", numObjects, setup,
+                       [&] { return guardAndDelete<ObjectGuard<Item>>(objects); })
+            && ok;
+    }
+
+    return ok ? 0 : 1;
+}
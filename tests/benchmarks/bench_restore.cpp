@@ -0,0 +1,113 @@
+/*
+  This file is part of KDDockWidgets.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+/// Measures how LayoutSaver::restoreLayout() scales with the number of dock widgets.
+/// Restoring does one DockRegistry lookup per saved dock widget, so per-dock time should
+/// stay roughly constant as the number of docks grows. Fails if it grows much faster than that.
+///
+/// Unlike bench_layouting this one needs a real frontend, so it's built with the tests, when
+/// KDDockWidgets_BENCHMARKS is on. It's timing based, so ctest doesn't run it.
+
+#include "../simple_test_framework.h"
+#include "../utils.h"
+#include "core/DockRegistry.h"
+#include "core/DockWidget.h"
+#include "core/MainWindow.h"
+#include "core/Platform.h"
+#include "LayoutSaver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <unordered_map>
+
+using namespace KDDockWidgets;
+using namespace KDDockWidgets::Core;
+using namespace KDDockWidgets::Tests;
+
+namespace {
+
+constexpr int s_docksPerGroup = 10;
+constexpr int s_numRuns = 3;
+constexpr double s_maxPerDockGrowth = 4;
+
+/// Returns how long restoring a layout with @p numDocks dock widgets took, in microseconds.
+/// Returns -1 on failure.
+double restoreTime(int numDocks)
+{
+    EnsureTopLevelsDeleted e;
+    auto m = createMainWindow(Size(1000, 1000), MainWindowOption_None, "mainWindow1");
+
+    // Docks are tabbed, in groups of s_docksPerGroup, so the layout itself stays small and
+    // we're mostly measuring per-dock costs
+    Core::DockWidget *groupLeader = nullptr;
+    for (int i = 0; i < numDocks; ++i) {
+        auto dock = createDockWidget(QString("dock") + QString::number(i),
+                                     Platform::instance()->tests_createView({ true, {}, { 100, 100 } }),
+                                     {}, {}, /*show=*/false);
+        if (i % s_docksPerGroup == 0) {
+            m->addDockWidget(dock, Location_OnRight);
+            groupLeader = dock;
+        } else {
+            groupLeader->addDockWidgetAsTab(dock);
+        }
+    }
+
+    LayoutSaver saver;
+    const QByteArray saved = saver.serializeLayout();
+
+    const auto start = std::chrono::steady_clock::now();
+    const bool ok = saver.restoreLayout(saved);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    if (!ok || DockRegistry::self()->dockwidgets().size() != numDocks)
+        return -1;
+
+    return double(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+}
+
+}
+
+KDDW_QCORO_TASK tst_restoreScaling()
+{
+    std::unordered_map<int, double> usPerDock;
+
+    std::printf("%-8s %14s %14s\n", "docks", "restore (us)", "us/dock");
+    for (int numDocks : { 50, 100, 200, 400, 800 }) {
+        // Best of a few runs, to filter out noise
+        double us = -1;
+        for (int run = 0; run < s_numRuns; ++run) {
+            const double runUs = restoreTime(numDocks);
+            CHECK(runUs >= 0);
+            us = us < 0 ? runUs : std::min(us, runUs);
+
+            // 1 event loop for DelayedDelete. Avoids LSAN warnings.
+            KDDW_CO_AWAIT Platform::instance()->tests_wait(1);
+        }
+
+        usPerDock[numDocks] = us / numDocks;
+        std::printf("%-8d %14.0f %14.1f\n", numDocks, us, usPerDock[numDocks]);
+        std::fflush(stdout);
+    }
+
+    // Restoring should be linear. If it were quadratic, per-dock time would grow 8x from 100 to
+    // 800 docks. Allow some slack for caches and noise, but not that much.
+    const double growth = usPerDock[800] / usPerDock[100];
+    std::printf("Per-dock time grew %.1fx from 100 to 800 docks\n", growth);
+    CHECK(growth < s_maxPerDockGrowth);
+
+    KDDW_TEST_RETURN(true);
+}
+
+static const auto s_tests = std::vector<KDDWTest> {
+    TEST(tst_restoreScaling),
+};
+
+#include "../tests_main.h"
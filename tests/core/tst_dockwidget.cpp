@@ -12,6 +12,7 @@
 #include "../simple_test_framework.h"
 #include "../utils.h"
 #include "core/DockWidget.h"
+#include "core/DockRegistry.h"
 #include "core/FloatingWindow.h"
 #include "core/DockWidget_p.h"
 #include "core/Group.h"
@@ -208,6 +209,47 @@ KDDW_QCORO_TASK tst_setSize()
     KDDW_TEST_RETURN(true);
 }
 
+KDDW_QCORO_TASK tst_setUniqueName()
+{
+    {
+        Tests::EnsureTopLevelsDeleted e;
+        auto dr = DockRegistry::self();
+        auto dw = Config::self().viewFactory()->createDockWidget("dw1")->asDockWidgetController();
+        CHECK_EQ(dr->dockByName("dw1"), dw);
+
+        dw->setUniqueName("dw2");
+        CHECK_EQ(dw->uniqueName(), QString("dw2"));
+        CHECK(!dr->dockByName("dw1"));
+        CHECK_EQ(dr->dockByName("dw2"), dw);
+
+        delete dw;
+        CHECK(!DockRegistry::self()->dockByName("dw2"));
+    }
+
+    {
+        // Swapping names collides temporarily, it's not an error
+        Tests::EnsureTopLevelsDeleted e;
+        auto dr = DockRegistry::self();
+        auto dw1 = Config::self().viewFactory()->createDockWidget("1")->asDockWidgetController();
+        auto dw2 = Config::self().viewFactory()->createDockWidget("2")->asDockWidgetController();
+
+        dw1->setUniqueName("2");
+        dw2->setUniqueName("1");
+        CHECK_EQ(dr->dockByName("1"), dw2);
+        CHECK_EQ(dr->dockByName("2"), dw1);
+
+        delete dw1;
+        CHECK(!dr->dockByName("2"));
+        CHECK_EQ(dr->dockByName("1"), dw2);
+        delete dw2;
+    }
+
+    // 1 event loop for DelayedDelete. Avoids LSAN warnings.
+    KDDW_CO_AWAIT Platform::instance()->tests_wait(1);
+
+    KDDW_TEST_RETURN(true);
+}
+
 static const auto s_tests = std::vector<KDDWTest> {
     TEST(tst_dockWidgetCtor),
     TEST(tst_toggleAction),
@@ -216,6 +258,7 @@ static const auto s_tests = std::vector<KDDWTest> {
     TEST(tst_setAsCurrentTab),
     TEST(tst_dwCloseAndReopen),
     TEST(tst_setSize),
+    TEST(tst_setUniqueName),
 };
 
 #include "../tests_main.h"
@@ -10,9 +10,13 @@
 */
 
 #include "../simple_test_framework.h"
+#include "../utils.h"
 #include "core/Separator.h"
 #include "core/Platform.h"
 #include "core/DropArea.h"
+#include "core/MainWindow.h"
+#include "core/layouting/LayoutingSeparator_p.h"
+#include "Config.h"
 
 using namespace KDDockWidgets;
 
@@ -26,6 +30,56 @@ KDDW_QCORO_TASK tst_separatorCtor()
     KDDW_TEST_RETURN(true);
 }
 
-static const auto s_tests = std::vector<KDDWTest> { TEST(tst_separatorCtor) };
+KDDW_QCORO_TASK tst_separatorMoveInterval()
+{
+    // Qt ignores separator mouse moves unless the left button is really pressed,
+    // which can't be faked here
+    if (Core::Platform::instance()->isQt())
+        KDDW_TEST_RETURN(true);
+
+    Tests::EnsureTopLevelsDeleted e; // Also restores the interval, even if a check fails
+    Config::self().setSeparatorMoveInterval(500);
+
+    auto m = Tests::createMainWindow(Size(800, 500), MainWindowOption_None);
+    auto dock1 = Tests::createDockWidget("dock1");
+    auto dock2 = Tests::createDockWidget("dock2");
+    m->addDockWidget(dock1, Location_OnLeft);
+    m->addDockWidget(dock2, Location_OnRight);
+
+    Core::Separator *separator = nullptr;
+    for (const auto &child : m->multiSplitter()->view()->childViews()) {
+        if (auto sep = child->asController<Core::Separator>())
+            separator = sep;
+    }
+    CHECK(separator);
+
+    const int originalPos = separator->position();
+    const int y = separator->asLayoutingSeparator()->geometry().center().y();
+    separator->onMousePress();
+
+    // 1st move is applied right away
+    separator->onMouseMove(Point(originalPos - 10, y));
+    CHECK_EQ(separator->position(), originalPos - 10);
+
+    // Following ones are coalesced
+    separator->onMouseMove(Point(originalPos - 20, y));
+    separator->onMouseMove(Point(originalPos - 30, y));
+    CHECK_EQ(separator->position(), originalPos - 10);
+
+    KDDW_CO_AWAIT Core::Platform::instance()->tests_wait(600);
+    CHECK_EQ(separator->position(), originalPos - 30);
+
+    // Release applies the latest position, no matter the interval
+    separator->onMouseMove(Point(originalPos - 40, y));
+    separator->onMouseReleased();
+    CHECK_EQ(separator->position(), originalPos - 40);
+
+    KDDW_TEST_RETURN(true);
+}
+
+static const auto s_tests = std::vector<KDDWTest> {
+    TEST(tst_separatorCtor),
+    TEST(tst_separatorMoveInterval),
+};
 
 #include "../tests_main.h"
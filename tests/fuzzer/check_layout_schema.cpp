@@ -0,0 +1,171 @@
+/*
+  This file is part of KDDockWidgets.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+/// Checks that LayoutSchemaValidator's rules match layout_schema.json.
+///
+/// Usage: check_layout_schema <path/to/layout_schema.json>
+///
+/// Only what the validator checks is compared: types, required members, members and array
+/// elements. Keywords like "enum" and "minimum" are documentation only.
+
+#include "core/LayoutSchemaValidator_p.h"
+
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <string>
+#include <utility>
+
+using namespace KDDockWidgets;
+using json = nlohmann::json;
+
+namespace {
+
+std::set<std::string> typesOf(const json &schema)
+{
+    auto it = schema.find("type");
+    if (it == schema.end())
+        return {};
+
+    if (it->is_string())
+        return { it->get<std::string>() };
+
+    return it->get<std::set<std::string>>();
+}
+
+std::set<std::string> keysOf(const json &schema, const char *keyword)
+{
+    std::set<std::string> keys;
+    auto it = schema.find(keyword);
+    if (it == schema.end())
+        return keys;
+
+    if (it->is_array()) {
+        for (const auto &key : *it)
+            keys.insert(key.get<std::string>());
+    } else {
+        for (const auto &member : it->items())
+            keys.insert(member.key());
+    }
+
+    return keys;
+}
+
+class SchemaComparator
+{
+public:
+    /// Compares @p expected, from layout_schema.json, with @p actual, from the validator.
+    /// References to definitions must match by name, the definitions are compared separately.
+    void compare(const json &expected, const json &actual, const std::string &path)
+    {
+        if (expected.contains("$ref") || actual.contains("$ref")) {
+            if (expected.value("$ref", "") != actual.value("$ref", ""))
+                report(path, "references " + actual.value("$ref", "nothing") + ", expected "
+                           + expected.value("$ref", "nothing"));
+            return;
+        }
+
+        if (typesOf(expected) != typesOf(actual))
+            report(path, "has type " + actual.value("type", json()).dump() + ", expected "
+                       + expected.value("type", json()).dump());
+
+        if (keysOf(expected, "required") != keysOf(actual, "required"))
+            report(path, "requires " + actual.value("required", json()).dump() + ", expected "
+                       + expected.value("required", json()).dump());
+
+        if (keysOf(expected, "properties") != keysOf(actual, "properties"))
+            report(path, "has members " + json(keysOf(actual, "properties")).dump() + ", expected "
+                       + json(keysOf(expected, "properties")).dump());
+
+        const json properties = expected.value("properties", json::object());
+        for (const auto &member : properties.items()) {
+            if (actual.contains("properties") && actual["properties"].contains(member.key()))
+                compare(member.value(), actual["properties"][member.key()],
+                        path + "." + member.key());
+        }
+
+        for (const char *keyword : { "additionalProperties", "items" }) {
+            if (expected.contains(keyword) != actual.contains(keyword)) {
+                report(path, std::string(actual.contains(keyword) ? "has " : "doesn't have ")
+                           + keyword);
+            } else if (expected.contains(keyword)) {
+                compare(expected[keyword], actual[keyword], path + "." + keyword);
+            }
+        }
+
+        const json expectedPrefixItems = expected.value("prefixItems", json::array());
+        const json actualPrefixItems = actual.value("prefixItems", json::array());
+        if (expectedPrefixItems.size() != actualPrefixItems.size()) {
+            report(path, "has " + std::to_string(actualPrefixItems.size())
+                       + " prefixItems, expected " + std::to_string(expectedPrefixItems.size()));
+        } else {
+            for (size_t i = 0; i < expectedPrefixItems.size(); ++i)
+                compare(expectedPrefixItems[i], actualPrefixItems[i],
+                        path + "[" + std::to_string(i) + "]");
+        }
+
+        for (const char *keyword : { "minItems", "maxItems" }) {
+            if (expected.value(keyword, json()) != actual.value(keyword, json()))
+                report(path, std::string("has a different ") + keyword);
+        }
+    }
+
+    int numErrors = 0;
+
+private:
+    void report(const std::string &path, const std::string &message)
+    {
+        std::fprintf(stderr, "%s %s\n", path.c_str(), message.c_str());
+        ++numErrors;
+    }
+};
+
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2) {
+        std::fprintf(stderr, "Usage: %s <path/to/layout_schema.json>\n", argv[0]);
+        return 1;
+    }
+
+    std::ifstream file(argv[1]);
+    const json expected = json::parse(file, nullptr, /*allow_exceptions=*/false);
+    if (expected.is_discarded()) {
+        std::fprintf(stderr, "Failed to parse %s\n", argv[1]);
+        return 1;
+    }
+
+    const json actual = LayoutSchemaValidator::schema();
+
+    SchemaComparator comparator;
+    comparator.compare(expected, actual, "$");
+
+    const std::set<std::string> definitions = keysOf(expected, "definitions");
+    if (definitions != keysOf(actual, "definitions")) {
+        std::fprintf(stderr, "The validator has definitions %s, expected %s\n",
+                     json(keysOf(actual, "definitions")).dump().c_str(),
+                     json(definitions).dump().c_str());
+        ++comparator.numErrors;
+    }
+
+    for (const std::string &definition : definitions) {
+        if (actual["definitions"].contains(definition))
+            comparator.compare(expected["definitions"][definition],
+                               actual["definitions"][definition], "#/definitions/" + definition);
+    }
+
+    if (comparator.numErrors > 0) {
+        std::fprintf(stderr, "LayoutSchemaValidator doesn't match %s\n", argv[1]);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,135 @@
+/*
+  This file is part of KDDockWidgets.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+/// Fuzzes restoring layouts from untrusted data, like a corrupted autosave.
+///
+/// Each input goes through LayoutSaver::prepareLayout(), which validates the structure, parses and
+/// then checks the result with LayoutSaver::Layout::isValid(). If accepted, each window's layout is
+/// restored into a headless layouting engine, like Layout::deserialize() does, with dummy guests
+/// instead of groups.
+///
+/// Built with clang, this is a libFuzzer target:
+///     $ fuzz_layoutsaver -max_len=200000 corpus/ ../tests/layouts/
+/// Otherwise it has its own main(), which runs each file passed as argument once. That's what ctest
+/// does, and it also works as an AFL target:
+///     $ afl-fuzz -i ../tests/layouts -o findings -- ./fuzz_layoutsaver @@
+///
+/// For fuzzing, build in release mode with sanitizers. Debug builds assert on some layouts that are
+/// merely nonsensical, like items with absurd sizes.
+
+#include "../utils_headless.h"
+#include "LayoutSaver.h"
+#include "core/LayoutSaver_p.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace KDDockWidgets;
+using namespace KDDockWidgets::Core;
+using namespace KDDockWidgets::Tests;
+
+namespace {
+
+bool initialize()
+{
+#ifdef KDDW_HAS_SPDLOG
+    // Rejecting corrupted data isn't a finding, don't flood the output with it
+    spdlog::set_level(spdlog::level::off);
+#endif
+
+    // Neither is a layout that doesn't make sense, only crashes and sanitizer reports are
+    Item::s_silenceSanityChecks = true;
+
+    Item::setCreateSeparatorFunc([](LayoutingHost *host, Qt::Orientation o,
+                                    ItemBoxContainer *container) -> LayoutingSeparator * {
+        return new DummySeparator(host, o, container);
+    });
+
+    return true;
+}
+
+/// Same as Layout::deserialize(), but headless
+void restoreLayout(const LayoutSaver::MultiSplitter &multiSplitter)
+{
+    DummyHost host;
+    auto root = std::make_unique<ItemBoxContainer>(&host);
+    host.m_rootItem = root.get();
+
+    std::vector<std::unique_ptr<DummyGuest>> guests;
+    std::unordered_map<QString, LayoutingGuest *> guestsById;
+    for (const auto &it : multiSplitter.groups) {
+        guests.push_back(std::make_unique<DummyGuest>(it.second.id, it.second.geometry));
+        guestsById[it.second.id] = guests.back().get();
+    }
+
+    root->fillFromJson(multiSplitter.layout, guestsById);
+    root->setSize_recursive(root->size().expandedTo(root->minSize()));
+
+    // Items go first, guests hold weak references to them
+    root.reset();
+}
+
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    static const bool initialized = initialize();
+    KDDW_UNUSED(initialized);
+
+    const QByteArray serialized =
+        QByteArray::fromStdString(std::string(reinterpret_cast<const char *>(data), size));
+
+    auto layout = LayoutSaver::prepareLayout(serialized);
+    if (!layout)
+        return 0;
+
+    for (const auto &mainWindow : layout->mainWindows)
+        restoreLayout(mainWindow.multiSplitterLayout);
+
+    for (const auto &floatingWindow : layout->floatingWindows)
+        restoreLayout(floatingWindow.multiSplitterLayout);
+
+    return 0;
+}
+
+#ifdef KDDW_FUZZER_STANDALONE
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: %s <file>...\n", argv[0]);
+        return 1;
+    }
+
+    for (int i = 1; i < argc; ++i) {
+        std::ifstream file(argv[i], std::ios::binary);
+        if (!file) {
+            std::fprintf(stderr, "Failed to open %s\n", argv[i]);
+            return 1;
+        }
+
+        std::stringstream contents;
+        contents << file.rdbuf();
+        const std::string input = contents.str();
+
+        std::printf("Running %s\n", argv[i]);
+        LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t *>(input.data()), input.size());
+    }
+
+    return 0;
+}
+
+#endif
@@ -50,6 +50,13 @@ class Schema {
 
     final type = jsonSchema["type"];
 
+    if (type is List) {
+      // Nullable, like "type": ["null", "array"]. We can just generate an empty
+      // array or object instead of honouring that null
+      jsonSchema["type"] = type.firstWhere((t) => t != "null");
+      return Schema.fromJson(jsonSchema, propertyName);
+    }
+
     if (type == "integer") {
       return IntegerSchema(jsonSchema, propertyName);
     } else if (type == "number") {
@@ -62,12 +69,6 @@ class Schema {
       return ObjectSchema(jsonSchema, propertyName);
     } else if (type == "string") {
       return StringSchema(jsonSchema, propertyName);
-    } else if (["lastOverlayedGeometries", "affinities"]
-        .contains(propertyName)) {
-      // lastOverlayedGeometries actually has "types" = [null, "array"],
-      // but we can just use an empty array instead of honouring that null
-      jsonSchema["type"] = "array";
-      return ArraySchema(jsonSchema, propertyName);
     }
 
     throw "fromJson: Unsupported type=${type}; propName=$propertyName; json=${jsonSchema}";
@@ -168,10 +169,10 @@ class ObjectSchema extends Schema {
     return props;
   }
 
-  Schema? patternProperties() {
-    Map<String, dynamic> props = jsonSchema["patternProperties"] ?? {};
-    if (props.isNotEmpty) {
-      final String definition = props.entries.first.value["\$ref"];
+  Schema? additionalProperties() {
+    final props = jsonSchema["additionalProperties"];
+    if (props != null) {
+      final String definition = props["\$ref"];
       return Fuzzer.self.schemaForDefinition(definition, propertyName);
     }
 
@@ -197,8 +198,8 @@ class ObjectSchema extends Schema {
       json[propSchema.propertyName] = propSchema.generate();
     }
 
-    final Schema? _patternProps = patternProperties();
-    if (_patternProps != null) {
+    final Schema? _additionalProps = additionalProperties();
+    if (_additionalProps != null) {
       // TODO
     }
 
@@ -49,6 +49,8 @@
 
 #ifdef KDDW_HAS_SPDLOG
 #include "../fatal_logger.h"
+#define KDDW_TESTS_COUNT_ALLOCATIONS
+#include "../utils_headless.h"
 #endif
 
 #include "../src/qtwidgets/DebugWidgetViewer_p.h"
@@ -217,6 +219,7 @@ private Q_SLOTS:
     void tst_debugWidgetViewer();
     void tst_addDockWidgetToContainingWindowNested();
     void tst_restoreInvalidPercentages();
+    void tst_viewWrapperCache();
 
     // And fix these
     void tst_floatingWindowDeleted();
@@ -2972,6 +2975,59 @@ void TestQtWidgets::tst_restoreInvalidPercentages()
     QVERIFY(!saver.serializeLayout().isEmpty());
 }
 
+void TestQtWidgets::tst_viewWrapperCache()
+{
+    EnsureTopLevelsDeleted e;
+
+    auto m = createMainWindow(Size(500, 500), MainWindowOption_None, "mainWindowId1");
+    auto dock = createDockWidget("dock1", new QPushButton("one"));
+    m->addDockWidget(dock, Location_OnLeft);
+
+    // Walking up the tree twice returns the same wrappers, nothing is allocated the 2nd time
+    QWidget *guest = QtCommon::View_qt::asQWidget(dock->guestView().get());
+    auto wrapper1 = QtWidgets::ViewWrapper::create(guest->parentWidget());
+    auto wrapper2 = QtWidgets::ViewWrapper::create(guest->parentWidget());
+    QCOMPARE(wrapper1.get(), wrapper2.get());
+    QCOMPARE(wrapper1->controller(), dock->view()->controller());
+
+    // A stray widget gets a dummy controller
+    auto stray = new QWidget();
+    auto strayWrapper = QtWidgets::ViewWrapper::create(stray);
+    QVERIFY(strayWrapper->controller()->is(ViewType::ViewWrapper));
+    QCOMPARE(strayWrapper.get(), QtWidgets::ViewWrapper::create(stray).get());
+
+    // Deleting the widget evicts its wrapper. Wrappers held elsewhere become null.
+    delete stray;
+    QVERIFY(strayWrapper->isNull());
+
+    delete dock;
+    QVERIFY(wrapper1->isNull());
+
+    // A wrapper lives as long as its widget, so walking up the view tree only allocates once
+    auto dock2 = createDockWidget("dock2", new QPushButton("two"));
+    m->addDockWidget(dock2, Location_OnLeft);
+
+    auto walkAncestors = [dock2] {
+        int depth = 0;
+        for (auto view = dock2->guestView()->parentView(); view; view = view->parentView())
+            ++depth;
+        return depth;
+    };
+
+    const int depth = walkAncestors();
+    QVERIFY(depth > 3);
+
+    const uint64_t allocationsBefore = Tests::s_numAllocations;
+    QCOMPARE(walkAncestors(), depth);
+    QCOMPARE(Tests::s_numAllocations - allocationsBefore, uint64_t(0));
+
+    auto button = new QPushButton("three");
+    std::weak_ptr<Core::View> weakWrapper = QtWidgets::ViewWrapper::create(button);
+    QVERIFY(!weakWrapper.expired());
+    delete button;
+    QVERIFY(weakWrapper.expired());
+}
+
 int main(int argc, char *argv[])
 {
 #ifdef KDDW_HAS_SPDLOG
@@ -18,10 +18,15 @@
 #include "utils.h"
 #include "core/LayoutSaver_p.h"
 #include "core/ScopedValueRollback_p.h"
+#include "core/WidgetResizeHandler_p.h"
 #include "core/Position_p.h"
 #include "core/TitleBar_p.h"
 #include "core/TabBar_p.h"
 #include "core/Action_p.h"
+#include "core/DelayedCall_p.h"
+#include "core/DockRegistry_p.h"
+#include "core/Group_p.h"
+#include "core/Platform_p.h"
 #include "core/WindowBeingDragged_p.h"
 #include "core/Logging_p.h"
 #include "core/layouting/Item_p.h"
@@ -31,9 +36,11 @@
 #include "core/Action.h"
 #include "core/MDILayout.h"
 #include "core/DropArea.h"
+#include "core/indicators/SegmentedDropIndicatorOverlay.h"
 #include "core/MainWindow.h"
 #include "core/DockWidget.h"
 #include "core/DockWidget_p.h"
+#include "core/DragTracer.h"
 #include "core/Separator.h"
 #include "core/TabBar.h"
 #include "core/Stack.h"
@@ -41,6 +48,19 @@
 #include "core/Platform.h"
 
 #include <cstdlib>
+#include <sstream>
+#include <thread>
+
+#ifdef KDDockWidgets_XLIB
+#include "core/WindowZOrder_x11_p.h"
+
+#include <QGuiApplication>
+#include <QtGui/qpa/qplatformnativeinterface.h>
+
+#include <xcb/xcb.h>
+
+#include <unordered_set>
+#endif
 
 #ifdef Q_OS_WIN
 #include <windows.h>
@@ -173,6 +193,42 @@ KDDW_QCORO_TASK tst_resizeWindow2()
     KDDW_TEST_RETURN(true);
 }
 
+KDDW_QCORO_TASK tst_groupContainingPos()
+{
+    EnsureTopLevelsDeleted e;
+    auto m = createMainWindow(Size(800, 500), MainWindowOption_None);
+    auto dock1 = createDockWidget("1");
+    auto dock2 = createDockWidget("2");
+    auto dock3 = createDockWidget("3");
+    m->addDockWidget(dock1, Location_OnLeft);
+    m->addDockWidget(dock2, Location_OnRight);
+    m->addDockWidget(dock3, Location_OnBottom);
+
+    auto dropArea = m->multiSplitter();
+    auto centerOf = [](Core::Group *group) {
+        return group->view()->mapToGlobal(group->view()->rect().center());
+    };
+
+    Core::Group *group1 = dock1->dptr()->group();
+    Core::Group *group2 = dock2->dptr()->group();
+    const Point group2Center = centerOf(group2);
+    CHECK_EQ(dropArea->groupContainingPos(centerOf(group1)), group1);
+    CHECK_EQ(dropArea->groupContainingPos(group2Center), group2);
+    CHECK_EQ(dropArea->groupContainingPos(centerOf(dock3->dptr()->group())), dock3->dptr()->group());
+    CHECK(!dropArea->groupContainingPos(m->view()->mapToGlobal(Point(-10, -10))));
+
+    // The layout changed, so positions need to be looked up again
+    dock2->close();
+    CHECK(dropArea->groupContainingPos(group2Center) != group2);
+    CHECK_EQ(dropArea->groupContainingPos(centerOf(group1)), group1);
+
+    dock1->addDockWidgetToContainingWindow(dock2, Location_OnRight, dock1);
+    CHECK_EQ(dropArea->groupContainingPos(centerOf(dock2->dptr()->group())), dock2->dptr()->group());
+    CHECK_EQ(dropArea->groupContainingPos(centerOf(group1)), group1);
+
+    KDDW_TEST_RETURN(true);
+}
+
 KDDW_QCORO_TASK tst_hasPreviousDockedLocation()
 {
     // Tests Core::DockWidget::hasPreviousDockedLocation()
@@ -643,6 +699,325 @@ KDDW_QCORO_TASK tst_restoreNlohmanException()
     KDDW_TEST_RETURN(true);
 }
 
+KDDW_QCORO_TASK tst_restoreCbor()
+{
+    EnsureTopLevelsDeleted e;
+
+    auto m = createMainWindow(Size(800, 500), MainWindowOption_None, "tst_restoreCbor");
+    auto dock1 = createDockWidget("1", Platform::instance()->tests_createView({ true }));
+    auto dock2 = createDockWidget("2", Platform::instance()->tests_createView({ true }));
+    auto dock3 = createDockWidget("3", Platform::instance()->tests_createView({ true }));
+    m->addDockWidget(dock1, Location_OnLeft);
+    m->addDockWidget(dock2, Location_OnRight);
+    dock3->dptr()->morphIntoFloatingWindow();
+
+    LayoutSaver saver;
+    const QByteArray json = saver.serializeLayout();
+    saver.setFormat(LayoutSaverFormat::Cbor);
+    CHECK(saver.format() == LayoutSaverFormat::Cbor);
+    const QByteArray cbor = saver.serializeLayout();
+    CHECK(!cbor.isEmpty());
+    CHECK(cbor.size() < json.size());
+
+    // Both formats describe the same layout
+    LayoutSaver::Layout fromJson;
+    CHECK(fromJson.fromSerialized(json));
+    LayoutSaver::Layout fromCbor;
+    CHECK(fromCbor.fromSerialized(cbor));
+    CHECK_EQ(fromCbor.dockWidgetNames(), fromJson.dockWidgetNames());
+    CHECK_EQ(fromCbor.mainWindowNames(), fromJson.mainWindowNames());
+
+    dock2->close();
+    CHECK(saver.restoreLayout(cbor));
+    CHECK(dock2->isOpen());
+    CHECK(dock1->isInMainWindow());
+    CHECK(dock2->isInMainWindow());
+    CHECK(dock3->isFloating());
+
+    // JSON still loads when the saver is set to CBOR
+    CHECK(saver.restoreLayout(json));
+    CHECK(m->layout()->checkSanity());
+
+    KDDW_TEST_RETURN(true);
+}
+
+KDDW_QCORO_TASK tst_layoutStreaming()
+{
+    EnsureTopLevelsDeleted e;
+
+    auto m = createMainWindow(Size(800, 500), MainWindowOption_None, "tst_layoutStreaming");
+    auto dock1 = createDockWidget("1", Platform::instance()->tests_createView({ true }));
+    auto dock2 = createDockWidget("2", Platform::instance()->tests_createView({ true }));
+    auto dock3 = createDockWidget("3", Platform::instance()->tests_createView({ true }));
+    auto dock4 = createDockWidget("4", Platform::instance()->tests_createView({ true }));
+    m->addDockWidget(dock1, Location_OnLeft);
+    m->addDockWidget(dock2, Location_OnRight);
+    dock1->addDockWidgetAsTab(dock4);
+    dock3->dptr()->morphIntoFloatingWindow();
+    dock4->close();
+
+    LayoutSaver saver;
+    const QByteArray json = saver.serializeLayout();
+    CHECK(!json.isEmpty());
+
+    // Reading it back and writing it again is lossless
+    LayoutSaver::Layout layout;
+    CHECK(layout.fromJson(json));
+    CHECK_EQ(layout.mainWindows.size(), 1);
+    CHECK_EQ(layout.floatingWindows.size(), 1);
+    CHECK_EQ(layout.closedDockWidgets.size(), 1);
+    CHECK_EQ(layout.allDockWidgets.size(), 4);
+    CHECK(layout.toJson() == json);
+
+    // Streaming into a std::ostream writes the same
+    std::ostringstream stream;
+    CHECK(layout.toJson(stream));
+    CHECK(QByteArray::fromStdString(stream.str()) == json);
+
+    // Byte for byte what going through a DOM writes, placeholders and closed docks included
+    const nlohmann::json dom = layout;
+    CHECK(stream.str() == dom.dump(4));
+    CHECK(!dom["allDockWidgets"][0]["lastPosition"]["placeholders"].empty());
+
+    // CBOR is parsed by the same reader
+    LayoutSaver::Layout fromCbor;
+    CHECK(fromCbor.fromCbor(layout.toCbor()));
+    CHECK(fromCbor.toJson() == json);
+
+    // Valid JSON, but not a layout
+    LayoutSaver::Layout invalid;
+    CHECK(!invalid.fromJson(QByteArray("[1]")));
+    CHECK(!invalid.fromJson(QByteArray("{\"mainWindows\": null}")));
+    CHECK(!invalid.fromJson(QByteArray("{\"mainWindows\": []")));
+
+    // A failed parse leaves the layout untouched
+    CHECK(!layout.fromJson(QByteArray("{\"mainWindows\": [], \"floatingWindows\": [")));
+    CHECK_EQ(layout.mainWindows.size(), 1);
+    CHECK(layout.toJson() == json);
+
+    CHECK(saver.restoreLayout(json));
+    CHECK(dock1->isInMainWindow());
+    CHECK(dock3->isFloating());
+    CHECK(!dock4->isOpen());
+
+    KDDW_TEST_RETURN(true);
+}
+
+KDDW_QCORO_TASK tst_restoreProfile()
+{
+    EnsureTopLevelsDeleted e;
+
+    auto m = createMainWindow(Size(800, 500), MainWindowOption_None, "tst_restoreProfile");
+    auto dock1 = createDockWidget("1", Platform::instance()->tests_createView({ true }));
+    auto dock2 = createDockWidget("2", Platform::instance()->tests_createView({ true }));
+    auto dock3 = createDockWidget("3", Platform::instance()->tests_createView({ true }));
+    m->addDockWidget(dock1, Location_OnLeft);
+    m->addDockWidget(dock2, Location_OnRight);
+    dock3->dptr()->morphIntoFloatingWindow();
+
+    LayoutSaver saver;
+    const QByteArray saved = saver.serializeLayout();
+
+    // Disabled by default
+    CHECK(!saver.restoreProfilingEnabled());
+    CHECK(saver.restoreLayout(saved));
+    CHECK(!saver.lastRestoreProfile().isValid);
+
+    saver.setRestoreProfilingEnabled(true);
+    CHECK(saver.restoreLayout(saved));
+
+    using Phase = LayoutSaver::RestoreProfile::Phase;
+    const LayoutSaver::RestoreProfile profile = saver.lastRestoreProfile();
+    CHECK(profile.isValid);
+    CHECK(profile.totalDurationUs() >= profile.stats(Phase::MainWindows).durationUs);
+
+    // The main window gets 2 groups, side by side
+    const auto &mainWindowStats = profile.stats(Phase::MainWindows);
+    CHECK_EQ(mainWindowStats.numGroupsCreated, 2);
+    CHECK(mainWindowStats.numItemsCreated >= 2);
+    CHECK(mainWindowStats.numSeparatorsCreated >= 1);
+    CHECK_EQ(profile.stats(Phase::FloatingWindows).numGroupsCreated, 1);
+    CHECK_EQ(profile.stats(Phase::Parse).numGroupsCreated, 0);
+
+    const QByteArray profileJson = profile.toJson();
+    const nlohmann::json json = nlohmann::json::parse(profileJson.constData(), profileJson.constData() + profileJson.size());
+    CHECK_EQ(json["phases"].size(), size_t(Phase::Count));
+    CHECK(json["phases"][int(Phase::MainWindows)]["name"] == "MainWindows");
+    CHECK(json["phases"][int(Phase::MainWindows)]["groupsCreated"] == 2);
+
+    KDDW_TEST_RETURN(true);
+}
+
+KDDW_QCORO_TASK tst_layoutDelta()
+{
+    EnsureTopLevelsDeleted e;
+
+    auto m = createMainWindow(Size(800, 500), MainWindowOption_None, "tst_layoutDelta");
+    auto dock1 = createDockWidget("1", Platform::instance()->tests_createView({ true }));
+    auto dock2 = createDockWidget("2", Platform::instance()->tests_createView({ true }));
+    auto dock3 = createDockWidget("3", Platform::instance()->tests_createView({ true }));
+    m->addDockWidget(dock1, Location_OnLeft);
+    m->addDockWidget(dock2, Location_OnRight);
+    dock3->dptr()->morphIntoFloatingWindow();
+
+    LayoutSaver saver;
+    auto parse = [](const QByteArray &data) {
+        return nlohmann::json::parse(data.constData(), data.constData() + data.size());
+    };
+
+    // The first delta has everything
+    const QByteArray delta1 = saver.serializeLayoutDelta();
+    const QByteArray layout1 = LayoutSaver::applyLayoutDelta({}, delta1);
+    CHECK(!layout1.isEmpty());
+    CHECK(parse(layout1) == parse(saver.serializeLayout()));
+
+    // Nothing changed
+    const QByteArray delta2 = saver.serializeLayoutDelta();
+    CHECK(delta2.size() < delta1.size());
+    const nlohmann::json delta2Json = parse(delta2);
+    CHECK(delta2Json["mainWindows"].empty());
+    CHECK(delta2Json["allDockWidgets"].empty());
+    CHECK(!delta2Json.contains("floatingWindows"));
+    const QByteArray layout2 = LayoutSaver::applyLayoutDelta(layout1, delta2);
+    CHECK(parse(layout2) == parse(layout1));
+
+    // Only the main window and the docks which were in it change
+    dock2->close();
+    const QByteArray delta3 = saver.serializeLayoutDelta();
+    const nlohmann::json delta3Json = parse(delta3);
+    CHECK(delta3Json["mainWindows"].contains("tst_layoutDelta"));
+    CHECK(delta3Json["allDockWidgets"].contains("2"));
+    CHECK(!delta3Json["allDockWidgets"].contains("3"));
+    CHECK(!delta3Json.contains("floatingWindows"));
+    const QByteArray layout3 = LayoutSaver::applyLayoutDelta(layout2, delta3);
+    CHECK(parse(layout3) == parse(saver.serializeLayout()));
+
+    // Floating a dock changes its position and the floating windows
+    dock1->setFloating(true);
+    const QByteArray delta4 = saver.serializeLayoutDelta();
+    const nlohmann::json delta4Json = parse(delta4);
+    CHECK(delta4Json["allDockWidgets"].contains("1"));
+    CHECK(!delta4Json["allDockWidgets"].contains("3"));
+    CHECK(delta4Json.contains("floatingWindows"));
+    const QByteArray layout4 = LayoutSaver::applyLayoutDelta(layout3, delta4);
+    CHECK(parse(layout4) == parse(saver.serializeLayout()));
+    CHECK(parse(saver.serializeLayoutDelta())["allDockWidgets"].empty());
+
+    // A delta only applies to the layout it was based on
+    {
+        SetExpectedWarning ignoreWarning("Delta doesn't apply");
+        CHECK(LayoutSaver::applyLayoutDelta({}, delta3).isEmpty());
+    }
+
+    CHECK(saver.restoreLayout(layout1));
+    CHECK(dock2->isOpen());
+    CHECK(dock3->isFloating());
+    CHECK(m->layout()->checkSanity());
+
+    KDDW_TEST_RETURN(true);
+}
+
+KDDW_QCORO_TASK tst_restorePreparedLayout()
+{
+    EnsureTopLevelsDeleted e;
+
+    auto m = createMainWindow(Size(800, 500), MainWindowOption_None, "tst_restorePreparedLayout");
+    auto dock1 = createDockWidget("1", Platform::instance()->tests_createView({ true }));
+    auto dock2 = createDockWidget("2", Platform::instance()->tests_createView({ true }));
+    auto dock3 = createDockWidget("3", Platform::instance()->tests_createView({ true }));
+    m->addDockWidget(dock1, Location_OnLeft);
+    dock1->addDockWidgetAsTab(dock2);
+    dock3->dptr()->morphIntoFloatingWindow();
+
+    LayoutSaver saver;
+    const QByteArray saved = saver.serializeLayout();
+
+    // Parsing happens in a worker thread
+    std::shared_ptr<LayoutSaver::Layout> prepared;
+    std::thread thread([&saved, &prepared] {
+        prepared = LayoutSaver::prepareLayout(saved);
+    });
+    thread.join();
+
+    CHECK(prepared);
+    CHECK_EQ(prepared->dockWidgetNames().size(), 3);
+    // Dock widgets are shared between their group and allDockWidgets
+    const LayoutSaver::MultiSplitter &multiSplitter = prepared->mainWindows.constFirst().multiSplitterLayout;
+    CHECK_EQ(multiSplitter.groups.size(), 1);
+    CHECK(multiSplitter.groups.cbegin()->second.dockWidgets.contains(prepared->allDockWidgets.constFirst()));
+
+    dock2->close();
+    dock3->close();
+    CHECK(saver.restoreLayout(prepared));
+    CHECK(dock2->isOpen());
+    CHECK(dock3->isFloating());
+    CHECK_EQ(dock1->dptr()->group(), dock2->dptr()->group());
+    CHECK(m->layout()->checkSanity());
+
+    {
+        SetExpectedWarning ignoreWarning("A prepared layout can only be restored once");
+        CHECK(!saver.restoreLayout(prepared));
+    }
+
+    {
+        SetExpectedWarning ignoreWarning("Refusing to restore malformed layout");
+        CHECK(!LayoutSaver::prepareLayout("not a layout"));
+    }
+
+    KDDW_TEST_RETURN(true);
+}
+
+KDDW_QCORO_TASK tst_restoreMalformedLayout()
+{
+    EnsureTopLevelsDeleted e;
+
+    auto m = createMainWindow(Size(800, 500), MainWindowOption_None, "tst_restoreMalformedLayout");
+    auto dock1 = createDockWidget("1", Platform::instance()->tests_createView({ true }));
+    auto dock2 = createDockWidget("2", Platform::instance()->tests_createView({ true }));
+    m->addDockWidget(dock1, Location_OnLeft);
+    m->addDockWidget(dock2, Location_OnRight);
+
+    LayoutSaver saver;
+    const QByteArray saved = saver.serializeLayout();
+    CHECK(LayoutSaver::Layout::isWellFormed(saved));
+
+    saver.setFormat(LayoutSaverFormat::Cbor);
+    CHECK(LayoutSaver::Layout::isWellFormed(saver.serializeLayout()));
+
+    nlohmann::json json = nlohmann::json::parse(saved.constData(), saved.constData() + saved.size());
+    nlohmann::json &layout = json["mainWindows"][0]["multiSplitterLayout"]["layout"];
+
+    dock2->close();
+
+    {
+        // Wrong type, it's rejected before anything is parsed
+        nlohmann::json corrupted = json;
+        corrupted["mainWindows"][0]["multiSplitterLayout"]["layout"]["isVisible"] = "yes";
+        const QByteArray data = QByteArray::fromStdString(corrupted.dump());
+
+        std::string error;
+        CHECK(!LayoutSaver::Layout::isWellFormed(data, &error));
+        CHECK(error.find("mainWindows[0].multiSplitterLayout.layout.isVisible") != std::string::npos);
+
+        SetExpectedWarning ignoreWarning("Refusing to restore malformed layout");
+        CHECK(!saver.restoreLayout(data));
+        CHECK(!dock2->isOpen());
+    }
+
+    {
+        // Well formed, but an item refers to a group which isn't in the layout
+        layout["children"][0]["guestId"] = "not-a-group";
+        const QByteArray data = QByteArray::fromStdString(json.dump());
+        CHECK(LayoutSaver::Layout::isWellFormed(data));
+
+        SetExpectedWarning ignoreWarning("Layout item refers to unknown group");
+        CHECK(!saver.restoreLayout(data));
+        CHECK(!dock2->isOpen());
+    }
+
+    KDDW_TEST_RETURN(true);
+}
+
 KDDW_QCORO_TASK tst_restoreEmpty()
 {
     EnsureTopLevelsDeleted e;
@@ -1141,6 +1516,184 @@ KDDW_QCORO_TASK tst_doubleScheduleDelete()
     KDDW_TEST_RETURN(true);
 }
 
+KDDW_QCORO_TASK tst_delayedCallQueue()
+{
+    EnsureTopLevelsDeleted e;
+    auto dock1 = createDockWidget("dock1", Platform::instance()->tests_createView({ true }), {}, {}, false);
+
+    std::vector<bool> emitted;
+    KDBindings::ScopedConnection conn = dock1->d->isFocusedChanged.connect([&emitted](bool focused) {
+        emitted.push_back(focused);
+    });
+
+    // Consecutive duplicates collapse, but each transition is still emitted, in order
+    DelayedCallQueue &queue = Platform::instance()->d->delayedCallQueue;
+    queue.schedule(0, new DelayedEmitFocusChanged(dock1, true));
+    queue.schedule(0, new DelayedEmitFocusChanged(dock1, true));
+    queue.schedule(0, new DelayedEmitFocusChanged(dock1, false));
+    queue.schedule(0, new DelayedEmitFocusChanged(dock1, true));
+    CHECK_EQ(queue.numPendingCalls(), 3);
+
+    KDDW_CO_AWAIT Platform::instance()->tests_wait(100);
+    CHECK_EQ(queue.numPendingCalls(), 0);
+    CHECK(emitted == std::vector<bool>({ true, false, true }));
+
+    KDDW_TEST_RETURN(true);
+}
+
+KDDW_QCORO_TASK tst_focusScopeDispatch()
+{
+    EnsureTopLevelsDeleted e;
+
+    auto m = createMainWindow(Size(800, 500), MainWindowOption_None, "tst_focusScopeDispatch");
+    auto dock1 = createDockWidget("1", Platform::instance()->tests_createView({ true }));
+    auto dock2 = createDockWidget("2", Platform::instance()->tests_createView({ true }));
+    auto dock3 = createDockWidget("3", Platform::instance()->tests_createView({ true }));
+    m->addDockWidget(dock1, Location_OnLeft);
+    m->addDockWidget(dock2, Location_OnRight);
+    m->addDockWidget(dock3, Location_OnBottom);
+
+    Core::Group *group1 = dock1->dptr()->group();
+    Core::Group *group2 = dock2->dptr()->group();
+    Core::Group *group3 = dock3->dptr()->group();
+
+    // Groups not involved in a focus change aren't notified at all
+    int group3Emissions = 0;
+    KDBindings::ScopedConnection conn = group3->dptr()->isFocusedChanged.connect([&group3Emissions] {
+        group3Emissions++;
+    });
+
+    auto &focusedViewChanged = Platform::instance()->d->focusedViewChanged;
+    const auto &focusedScopes = DockRegistry::self()->dptr()->m_focusedScopes;
+
+    focusedViewChanged.emit(dock1->guestView());
+    CHECK(group1->isFocused());
+    CHECK(!group2->isFocused());
+    CHECK(!group3->isFocused());
+    CHECK_EQ(focusedScopes.size(), 1);
+    CHECK_EQ(DockRegistry::self()->focusedDockWidget(), dock1);
+
+    focusedViewChanged.emit(dock2->guestView());
+    CHECK(!group1->isFocused());
+    CHECK(group2->isFocused());
+    CHECK(!group3->isFocused());
+    CHECK_EQ(focusedScopes.size(), 1);
+    CHECK_EQ(DockRegistry::self()->focusedDockWidget(), dock2);
+
+    focusedViewChanged.emit(nullptr);
+    CHECK(!group1->isFocused());
+    CHECK(!group2->isFocused());
+    CHECK(focusedScopes.isEmpty());
+    CHECK(!DockRegistry::self()->focusedDockWidget());
+
+    CHECK_EQ(group3Emissions, 0);
+
+    KDDW_TEST_RETURN(true);
+}
+
+#ifdef KDDockWidgets_XLIB
+/// Reads _NET_CLIENT_LIST_STACKING from the X server, bypassing WindowZOrder's cache.
+/// Returns the handles of @p windows, bottom to top. Empty if there's no EWMH window manager.
+static std::vector<WId> stackingOrderFromServer(const Core::Window::List &windows)
+{
+    auto nativeInterface = qGuiApp->platformNativeInterface();
+    auto connection = static_cast<xcb_connection_t *>(
+        nativeInterface->nativeResourceForIntegration(QByteArrayLiteral("connection")));
+    const xcb_window_t root = xcb_setup_roots_iterator(xcb_get_setup(connection)).data->root;
+
+    const char atomName[] = "_NET_CLIENT_LIST_STACKING";
+    xcb_intern_atom_reply_t *atomReply = xcb_intern_atom_reply(
+        connection, xcb_intern_atom(connection, true, sizeof(atomName) - 1, atomName), nullptr);
+    if (!atomReply)
+        return {};
+
+    const xcb_atom_t atom = atomReply->atom;
+    free(atomReply);
+    if (atom == XCB_ATOM_NONE)
+        return {};
+
+    xcb_get_property_reply_t *reply = xcb_get_property_reply(
+        connection,
+        xcb_get_property(connection, false, root, atom, XCB_ATOM_WINDOW, 0, UINT32_MAX), nullptr);
+    if (!reply)
+        return {};
+
+    std::unordered_set<WId> ours;
+    for (const Core::Window::Ptr &window : windows)
+        ours.insert(window->handle());
+
+    std::vector<WId> result;
+    auto clients = static_cast<const xcb_window_t *>(xcb_get_property_value(reply));
+    const int numClients = xcb_get_property_value_length(reply) / int(sizeof(xcb_window_t));
+    for (int i = 0; i < numClients; ++i) {
+        if (ours.count(clients[i]) > 0)
+            result.push_back(clients[i]);
+    }
+
+    free(reply);
+    return result;
+}
+
+KDDW_QCORO_TASK tst_windowZOrderRoundTrips()
+{
+    // Run it under Xvfb
+    if (!isXCB())
+        KDDW_TEST_RETURN(true);
+
+    EnsureTopLevelsDeleted e;
+
+    auto m = createMainWindow(Size(800, 500), MainWindowOption_None, "tst_windowZOrderRoundTrips");
+    auto dock1 = createDockWidget("1", Platform::instance()->tests_createView({ true }));
+    auto dock2 = createDockWidget("2", Platform::instance()->tests_createView({ true }));
+    m->addDockWidget(dock1, Location_OnLeft);
+    CHECK(dock2->isFloating());
+    KDDW_CO_AWAIT Platform::instance()->tests_wait(100);
+
+    WindowZOrder &zorder = WindowZOrder::self();
+    zorder.invalidate();
+
+    bool ok = false;
+    CHECK_EQ(zorder.orderedWindows(ok).size(), 2);
+    CHECK(ok);
+
+    // Once the cache is built, mouse moves don't talk to the X server anymore
+    const int roundTrips = zorder.numRoundTrips();
+    for (int i = 0; i < 100; ++i) {
+        CHECK_EQ(zorder.orderedWindows(ok).size(), 2);
+        CHECK(ok);
+    }
+    CHECK_EQ(zorder.numRoundTrips(), roundTrips);
+
+    // A new top-level triggers a single rebuild
+    auto dock3 = createDockWidget("3", Platform::instance()->tests_createView({ true }));
+    CHECK(dock3->isFloating());
+    for (int i = 0; i < 100; ++i)
+        CHECK_EQ(zorder.orderedWindows(ok).size(), 3);
+    CHECK(zorder.numRoundTrips() > roundTrips);
+
+    const int roundTripsAfterRebuild = zorder.numRoundTrips();
+    zorder.orderedWindows(ok);
+    CHECK_EQ(zorder.numRoundTrips(), roundTripsAfterRebuild);
+
+    // After a restack, the cache agrees with what the window manager reports. dock3 was
+    // created last, raising the main window changes the order.
+    m->view()->raise();
+    KDDW_CO_AWAIT Platform::instance()->tests_wait(200);
+
+    const Core::Window::List topLevels = DockRegistry::self()->topLevels();
+    const std::vector<WId> serverOrder = stackingOrderFromServer(topLevels);
+    if (serverOrder.size() == size_t(topLevels.size())) {
+        std::vector<WId> cachedOrder;
+        for (const Core::Window::Ptr &window : zorder.orderedWindows(ok))
+            cachedOrder.push_back(window->handle());
+        CHECK(ok);
+        CHECK(cachedOrder == serverOrder);
+    }
+
+    KDDW_TEST_RETURN(true);
+}
+#endif
+
 KDDW_QCORO_TASK tst_repeatedShowHide()
 {
     EnsureTopLevelsDeleted e;
@@ -2493,6 +3046,76 @@ KDDW_QCORO_TASK tst_addAndReadd()
     KDDW_TEST_RETURN(true);
 }
 
+KDDW_QCORO_TASK tst_dragTracer()
+{
+    EnsureTopLevelsDeleted e;
+    auto m = createMainWindow();
+    auto dock1 = createDockWidget("dock1", Platform::instance()->tests_createView({ true }));
+    auto dock2 = createDockWidget("dock2", Platform::instance()->tests_createView({ true }));
+    m->addDockWidget(dock1, KDDockWidgets::Location_OnLeft);
+    auto fw = dock2->floatingWindow();
+    CHECK(fw);
+
+    DragTracer::setEnabled(true);
+    KDDW_CO_AWAIT dragFloatingWindowTo(fw, m->dropArea(), DropLocation_Right);
+    DragTracer::setEnabled(false);
+    CHECK(dock2->isInMainWindow());
+
+    const std::vector<DragTracer::Event> events = DragTracer::events();
+    auto hasStage = [&events](DragTracer::Stage stage) {
+        return std::any_of(events.cbegin(), events.cend(), [stage](const DragTracer::Event &event) {
+            return event.stage == stage;
+        });
+    };
+
+    CHECK(hasStage(DragTracer::Stage::MouseMove));
+    CHECK(hasStage(DragTracer::Stage::DropAreaUnderCursor));
+    CHECK(hasStage(DragTracer::Stage::DropAreaHover));
+    CHECK(hasStage(DragTracer::Stage::Drop));
+
+    const QByteArray trace = DragTracer::toChromeTraceJson();
+    const auto json = nlohmann::json::parse(trace.constData(), trace.constData() + trace.size());
+    CHECK_EQ(json["traceEvents"].size(), events.size());
+
+    // Oldest events are dropped when full
+    DragTracer::setCapacity(2);
+    CHECK(DragTracer::events().empty());
+    DragTracer::setEnabled(true);
+    for (int i = 0; i < 3; ++i)
+        DragTracer::Scope scope(DragTracer::Stage::Drop);
+    DragTracer::setEnabled(false);
+    CHECK_EQ(DragTracer::events().size(), size_t(2));
+
+    DragTracer::setCapacity(10000);
+
+    KDDW_TEST_RETURN(true);
+}
+
+#ifdef KDDW_HAS_SPDLOG
+KDDW_QCORO_TASK tst_logThrottle()
+{
+    // The logger is resolved once, and it's the one registered under spdlogLoggerName()
+    CHECK(spdlogLogger());
+    CHECK_EQ(spdlogLogger(), spdlog::get(spdlogLoggerName()).get());
+
+    LogThrottle throttle;
+    uint32_t suppressed = 1000;
+    CHECK(throttle.tryAcquire(1000000, suppressed));
+    CHECK_EQ(suppressed, 0u);
+
+    CHECK(!throttle.tryAcquire(1000000, suppressed));
+    CHECK(!throttle.tryAcquire(1000000, suppressed));
+
+    // With a zero interval every message goes through, and reports the ones dropped before
+    CHECK(throttle.tryAcquire(0, suppressed));
+    CHECK_EQ(suppressed, 2u);
+    CHECK(throttle.tryAcquire(0, suppressed));
+    CHECK_EQ(suppressed, 0u);
+
+    KDDW_TEST_RETURN(true);
+}
+#endif
+
 KDDW_QCORO_TASK tst_addToSmallMainWindow1()
 {
     EnsureTopLevelsDeleted e;
@@ -3544,6 +4167,78 @@ KDDW_QCORO_TASK tst_dragOverTitleBar()
     KDDW_TEST_RETURN(true);
 }
 
+KDDW_QCORO_TASK tst_segmentedIndicatorsHover()
+{
+    // Tests that hovering the segmented indicators picks the segment under the cursor, and only
+    // repaints when the hovered segment or the segments themselves change
+
+    // Polygon hit-testing is only implemented for Qt
+    if (!Platform::instance()->isQt())
+        KDDW_TEST_RETURN(true);
+
+    EnsureTopLevelsDeleted e;
+    ViewFactory::s_dropIndicatorType = DropIndicatorType::Segmented;
+
+    auto m = createMainWindow(Size(800, 500), MainWindowOption_None);
+    auto dock1 = createDockWidget("dock1", Platform::instance()->tests_createView({ true }));
+    auto dock2 = createDockWidget("dock2", Platform::instance()->tests_createView({ true }));
+    auto dock3 = createDockWidget("dock3", Platform::instance()->tests_createView({ true }));
+    m->addDockWidget(dock1, Location_OnLeft);
+    m->addDockWidget(dock2, Location_OnRight);
+
+    DropArea *da = m->dropArea();
+    auto overlay = dynamic_cast<SegmentedDropIndicatorOverlay *>(da->dropIndicatorOverlay());
+    CHECK(overlay);
+
+    // The average of a segment's points is inside it, as segments are convex
+    auto pointInSegment = [overlay](DropLocation loc) {
+        const Polygon &polygon = overlay->segments().at(loc);
+        int x = 0;
+        int y = 0;
+        for (Point p : polygon) {
+            x += p.x();
+            y += p.y();
+        }
+        const int count = std::max(1, int(polygon.size()));
+        return overlay->view()->mapToGlobal(Point(x / count, y / count));
+    };
+
+    Core::FloatingWindow *fw3 = dock3->floatingWindow();
+    WindowBeingDragged wbd(fw3, fw3);
+
+    Core::Group *group1 = dock1->dptr()->group();
+    const Point group1Center = group1->mapToGlobal(group1->view()->rect().center());
+    da->hover(&wbd, group1Center);
+    CHECK(!overlay->segments().empty());
+
+    const Point centerPt = pointInSegment(DropLocation_Center);
+    CHECK_EQ(da->hover(&wbd, centerPt), DropLocation_Center);
+    CHECK_EQ(overlay->currentDropLocation(), DropLocation_Center);
+    CHECK_EQ(overlay->hoveredPt(), overlay->view()->mapFromGlobal(centerPt));
+
+    // Moving within the same segment, with the same segments, doesn't repaint
+    int numRepaints = overlay->numRepaintRequests();
+    CHECK_EQ(da->hover(&wbd, centerPt + Point(1, 1)), DropLocation_Center);
+    CHECK_EQ(overlay->hoveredPt(), overlay->view()->mapFromGlobal(centerPt + Point(1, 1)));
+    CHECK_EQ(overlay->numRepaintRequests(), numRepaints);
+
+    // Hovering another segment repaints
+    const Point leftPt = pointInSegment(DropLocation_Left);
+    CHECK_EQ(da->hover(&wbd, leftPt), DropLocation_Left);
+    CHECK_EQ(overlay->numRepaintRequests(), numRepaints + 1);
+
+    // Same location, but over another group. The segments moved, so it repaints.
+    CHECK_EQ(da->hover(&wbd, group1Center), DropLocation_Center);
+    numRepaints = overlay->numRepaintRequests();
+    Core::Group *group2 = dock2->dptr()->group();
+    const Point group2Center = group2->mapToGlobal(group2->view()->rect().center());
+    CHECK_EQ(da->hover(&wbd, group2Center), DropLocation_Center);
+    CHECK_EQ(overlay->numRepaintRequests(), numRepaints + 1);
+    CHECK_EQ(overlay->hoveredPt(), overlay->view()->mapFromGlobal(group2Center));
+
+    KDDW_TEST_RETURN(true);
+}
+
 KDDW_QCORO_TASK tst_setFloatingGeometry()
 {
     EnsureTopLevelsDeleted e;
@@ -5563,6 +6258,99 @@ KDDW_QCORO_TASK tst_mdiZorder2()
     KDDW_TEST_RETURN(true);
 }
 
+KDDW_QCORO_TASK tst_mdiResizeCoordinator()
+{
+    // QtQuick's resize handlers are only enabled by MDIResizeHandlerHelper.qml, not testable here
+    if (Platform::instance()->isQtQuick())
+        KDDW_TEST_RETURN(true);
+
+    EnsureTopLevelsDeleted e;
+    auto m = createMainWindow(Size(800, 500), MainWindowOption_MDI);
+    auto mdiLayout = m->layout()->asMDILayout();
+
+    auto dock0 = createDockWidget("dock0", Platform::instance()->tests_createView({ true, {}, Size(200, 200) }));
+    auto dock1 = createDockWidget("dock1", Platform::instance()->tests_createView({ true, {}, Size(200, 200) }));
+    auto dock2 = createDockWidget("dock2", Platform::instance()->tests_createView({ true, {}, Size(200, 200) }));
+    mdiLayout->addDockWidget(dock0, Point(0, 0), {});
+    mdiLayout->addDockWidget(dock1, Point(400, 0), {});
+    mdiLayout->addDockWidget(dock2, Point(100, 100), {});
+
+    Core::Group *group0 = dock0->dptr()->group();
+    Core::Group *group1 = dock1->dptr()->group();
+    Core::Group *group2 = dock2->dptr()->group();
+
+    // A single coordinator for all groups of the layout
+    auto coordinator = MDIResizeCoordinator::forTarget(group0->view());
+    CHECK(coordinator);
+    CHECK_EQ(coordinator, MDIResizeCoordinator::forTarget(group1->view()));
+    CHECK_EQ(coordinator, MDIResizeCoordinator::forTarget(group2->view()));
+    CHECK(group0->resizeHandler());
+
+    View *mdiView = mdiLayout->view();
+
+    // Just outside of dock1's right edge, within its resize margin
+    const Point nearGroup1 = group1->view()->mapToGlobal(Point(group1->width() + 2, 50));
+    CHECK_EQ(coordinator->handlerForEvent(mdiView, nearGroup1), group1->resizeHandler());
+
+    // Just outside dock2's left edge. That's over dock0, but dock2 is on top of it.
+    const Point nearGroup2 = group2->view()->mapToGlobal(Point(-2, 50));
+    CHECK_EQ(coordinator->handlerForEvent(mdiView, nearGroup2), group2->resizeHandler());
+
+    // But if the cursor is over dock0 itself, then dock0 wins
+    CHECK_EQ(coordinator->handlerForEvent(group0->view(), nearGroup2), group0->resizeHandler());
+
+    // Far from all groups
+    CHECK(!coordinator->handlerForEvent(mdiView, mdiView->mapToGlobal(Point(700, 450))));
+
+    // Raising programmatically, without any click, changes the z-order too. dock0 is on top now.
+    dock0->raise();
+    CHECK_EQ(coordinator->handlerForEvent(mdiView, nearGroup2), group0->resizeHandler());
+
+    KDDW_TEST_RETURN(true);
+}
+
+KDDW_QCORO_TASK tst_layoutItemIndex()
+{
+    // Tests that Layout's cached lookups are kept in sync with the item tree
+    EnsureTopLevelsDeleted e;
+    auto m = createMainWindow(Size(800, 500), MainWindowOption_None);
+    auto layout = m->layout();
+
+    auto dock1 = createDockWidget("dock1", Platform::instance()->tests_createView({ true, {}, Size(200, 200) }));
+    auto dock2 = createDockWidget("dock2", Platform::instance()->tests_createView({ true, {}, Size(200, 200) }));
+    m->addDockWidget(dock1, Location_OnLeft);
+    m->addDockWidget(dock2, Location_OnRight);
+
+    Core::Group *group1 = dock1->dptr()->group();
+    Core::Group *group2 = dock2->dptr()->group();
+
+    CHECK_EQ(layout->groups().size(), 2);
+    CHECK_EQ(layout->items().size(), 2);
+    CHECK(layout->containsGroup(group1));
+    CHECK(layout->containsGroup(group2));
+    CHECK_EQ(layout->itemForGroup(group1), group1->layoutItem());
+    CHECK_EQ(layout->dockWidgets().size(), 2);
+
+    // Floating dock1 deletes its group, but leaves a placeholder item
+    CHECK(dock1->setFloating(true));
+    KDDW_CO_AWAIT Platform::instance()->tests_wait(1);
+    CHECK_EQ(layout->items().size(), 2);
+    CHECK_EQ(layout->groups().size(), 1);
+    CHECK_EQ(layout->groups().constFirst(), group2);
+    CHECK(!layout->containsGroup(dock1->dptr()->group()));
+    CHECK_EQ(layout->dockWidgets().size(), 1);
+
+    // Docking it back into a new group
+    m->addDockWidget(dock1, Location_OnBottom);
+    Core::Group *newGroup1 = dock1->dptr()->group();
+    CHECK(layout->containsGroup(newGroup1));
+    CHECK_EQ(layout->itemForGroup(newGroup1), newGroup1->layoutItem());
+    CHECK_EQ(layout->groups().size(), 2);
+    CHECK_EQ(m->dropArea()->groups().size(), 2);
+
+    KDDW_TEST_RETURN(true);
+}
+
 KDDW_QCORO_TASK tst_mixedMDIRestoreToArea()
 {
     EnsureTopLevelsDeleted e;
@@ -6210,6 +6998,7 @@ static const auto s_tests = std::vector<KDDWTest> {
     TEST(tst_simple1),
     TEST(tst_simple2),
     TEST(tst_resizeWindow2),
+    TEST(tst_groupContainingPos),
     TEST(tst_hasPreviousDockedLocation),
     TEST(tst_hasPreviousDockedLocation2),
     TEST(tst_LayoutSaverOpenedDocks),
@@ -6220,8 +7009,15 @@ static const auto s_tests = std::vector<KDDWTest> {
     TEST(tst_floatingWindowTitleBug),
     TEST(tst_setFloatingSimple),
     TEST(tst_dragOverTitleBar),
+    TEST(tst_segmentedIndicatorsHover),
     TEST(tst_setFloatingGeometry),
     TEST(tst_restoreEmpty),
+    TEST(tst_restoreCbor),
+    TEST(tst_layoutStreaming),
+    TEST(tst_restoreProfile),
+    TEST(tst_layoutDelta),
+    TEST(tst_restorePreparedLayout),
+    TEST(tst_restoreMalformedLayout),
     TEST(tst_restoreCentralFrame),
     TEST(tst_restoreNonExistingDockWidget),
     TEST(tst_shutdown),
@@ -6347,6 +7143,10 @@ static const auto s_tests = std::vector<KDDWTest> {
     TEST(tst_tabTitleChanges),
     TEST(tst_preventClose),
     TEST(tst_addAndReadd),
+    TEST(tst_dragTracer),
+#ifdef KDDW_HAS_SPDLOG
+    TEST(tst_logThrottle),
+#endif
     TEST(tst_notClosable),
     TEST(tst_availableSizeWithPlaceholders),
     TEST(tst_moreTitleBarCornerCases),
@@ -6364,12 +7164,19 @@ static const auto s_tests = std::vector<KDDWTest> {
     TEST(tst_mdiZorder),
     TEST(tst_mdiCrash),
     TEST(tst_mdiZorder2),
+    TEST(tst_mdiResizeCoordinator),
+    TEST(tst_layoutItemIndex),
     TEST(tst_mdiSetSize),
     TEST(tst_mixedMDIRestoreToArea),
     TEST(tst_redockToMDIRestoresPosition),
     TEST(tst_maximizeButton),
     TEST(tst_restoreAfterUnminimized),
     TEST(tst_doubleScheduleDelete),
+    TEST(tst_delayedCallQueue),
+    TEST(tst_focusScopeDispatch),
+#ifdef KDDockWidgets_XLIB
+    TEST(tst_windowZOrderRoundTrips),
+#endif
     TEST(tst_minimizeRestoreBug),
 #endif
     TEST(tst_keepLast)
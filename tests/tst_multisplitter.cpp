@@ -20,6 +20,7 @@
 #include "core/Utils_p.h"
 #include "core/ObjectGuard_p.h"
 #include "core/ScopedValueRollback_p.h"
+#include "Config.h"
 
 #include <memory.h>
 #include <cstdlib>
@@ -143,13 +144,8 @@ static std::unique_ptr<ItemBoxContainer> createRoot()
     return std::unique_ptr<ItemBoxContainer>(root);
 }
 
-static Item *createItem(Size minSz = {}, Size maxSz = {})
+static Guest *createGuest(const QString &name, Size minSz = {}, Size maxSz = {})
 {
-    static int count = 0;
-    count++;
-    auto item = new Item(nullptr);
-    item->setGeometry(Rect(0, 0, 200, 200));
-    item->setObjectName(QString::number(count));
     Core::CreateViewOptions opts;
     if (minSz.isValid())
         opts.minSize = minSz;
@@ -157,15 +153,56 @@ static Item *createItem(Size minSz = {}, Size maxSz = {})
         opts.maxSize = maxSz;
     auto guestView = Core::Platform::instance()->tests_createView(opts);
 
-    guestView->setViewName(item->objectName());
+    guestView->setViewName(name);
     auto guest = new Guest(guestView, s_views[s_views.size() - 1]->asLayoutingHost());
     guestView->d->beingDestroyed.connect([guest] {
         delete guest;
     });
-    item->setGuest(guest);
+    return guest;
+}
+
+static Item *createItem(Size minSz = {}, Size maxSz = {})
+{
+    static int count = 0;
+    count++;
+    auto item = new Item(nullptr);
+    item->setGeometry(Rect(0, 0, 200, 200));
+    item->setObjectName(QString::number(count));
+    item->setGuest(createGuest(item->objectName(), minSz, maxSz));
     return item;
 }
 
+/// Returns whether each separator sits right after its item and spans the whole container.
+/// Recurses into nested containers.
+static bool separatorsAreInPlace(const ItemBoxContainer *container)
+{
+    const Item::List children = container->visibleChildren();
+    const auto separators = container->separators();
+    if (separators.size() != std::max(0, int(children.size()) - 1))
+        return false;
+
+    const Rect containerRect = container->mapToRoot(container->rect());
+    const int offset = (Item::layoutSpacing - Item::separatorThickness) / 2;
+    for (int i = 0; i < separators.size(); ++i) {
+        const Rect itemRect = container->mapToRoot(children.at(i)->geometry());
+        const Rect expected = container->isVertical()
+            ? Rect(containerRect.x(), itemRect.bottom() + 1 + offset, containerRect.width(), Item::separatorThickness)
+            : Rect(itemRect.right() + 1 + offset, containerRect.y(), Item::separatorThickness, containerRect.height());
+
+        if (separators.at(i)->geometry() != expected)
+            return false;
+    }
+
+    for (Item *child : children) {
+        if (auto c = child->asBoxContainer()) {
+            if (!separatorsAreInPlace(c))
+                return false;
+        }
+    }
+
+    return true;
+}
+
 static ItemBoxContainer *createRootWithSingleItem()
 {
     auto dropArea = new DropArea(nullptr, MainWindowOption_None);
@@ -1610,6 +1647,14 @@ KDDW_QCORO_TASK tst_mapToRoot()
     CHECK_EQ(rootPt, Point(0, item1->height() + st));
     CHECK_EQ(c->mapFromRoot(rootPt), Point(0, 0));
 
+    // Origins are cached, they must follow when an ancestor moves
+    const int oldHeight1 = item1->height();
+    root->requestSeparatorMove(root->separators().constFirst(), 10);
+    CHECK_EQ(item1->height(), oldHeight1 + 10);
+    CHECK_EQ(c->mapToRoot(Point(0, 0)), Point(0, item1->height() + st));
+    CHECK_EQ(item22->mapToRoot(Point(0, 0)), Point(item21->width() + st, item1->height() + st));
+    CHECK_EQ(item22->mapFromRoot(item22->mapToRoot(Point(1, 1))), Point(1, 1));
+
     KDDW_TEST_RETURN(true);
 }
 
@@ -2313,6 +2358,260 @@ KDDW_QCORO_TASK tst_relayoutIfNeeded()
     KDDW_TEST_RETURN(true);
 }
 
+KDDW_QCORO_TASK tst_layoutTransaction()
+{
+    DeleteViews deleteViews;
+    int numGeometryChanged = 0; // declared before root, as it outlives the connection
+
+    auto root = createRoot();
+    root->setSize({ 1000, 1000 });
+
+    auto item1 = createItem();
+    auto item11 = createItem();
+    auto item2 = createItem();
+
+    root->insertItem(item1, Location_OnLeft);
+    root->insertItem(item2, Location_OnRight);
+    ItemBoxContainer::insertItemRelativeTo(item11, item1, Location_OnBottom);
+    CHECK(root->checkSanity());
+
+    auto guest11 = static_cast<Guest *>(item11->guest());
+    guest11->m_numSetGeometry = 0;
+    item11->geometryChanged.connect([&numGeometryChanged] { numGeometryChanged++; });
+
+    LayoutingHost *host = root->host();
+    {
+        LayoutTransaction transaction(host);
+        CHECK(LayoutTransaction::isActive(host));
+
+        root->setSize_recursive({ 1200, 1200 });
+        root->setSize_recursive({ 1100, 1300 });
+
+        // Nested transactions are merged into the outer one
+        {
+            LayoutTransaction nested(host);
+            root->setSize_recursive({ 1500, 1400 });
+        }
+
+        // Item geometry is up to date, but the guest doesn't know yet
+        CHECK(item11->hasPendingGeometry());
+        CHECK_EQ(guest11->m_numSetGeometry, 0);
+        CHECK_EQ(numGeometryChanged, 0);
+        CHECK(root->checkSanity());
+    }
+
+    CHECK(!LayoutTransaction::isActive(host));
+    CHECK(!item11->hasPendingGeometry());
+    CHECK_EQ(guest11->m_numSetGeometry, 1);
+    CHECK_EQ(numGeometryChanged, 1);
+    CHECK(root->checkSanity());
+
+    // A transaction doesn't affect other layouts
+    {
+        auto otherRoot = createRoot();
+        auto otherItem = createItem();
+        otherRoot->insertItem(otherItem, Location_OnLeft);
+        auto otherGuest = static_cast<Guest *>(otherItem->guest());
+        otherGuest->m_numSetGeometry = 0;
+
+        LayoutTransaction transaction(host);
+        CHECK(!LayoutTransaction::isActive(otherRoot->host()));
+        otherRoot->setSize_recursive({ 1200, 1200 });
+        CHECK(!otherItem->hasPendingGeometry());
+        CHECK_EQ(otherGuest->m_numSetGeometry, 1);
+    }
+
+    // Items deleted during a transaction are simply forgotten
+    {
+        LayoutTransaction transaction(host);
+        root->setSize_recursive({ 1000, 1000 });
+        root->removeItem(item2);
+    }
+
+    CHECK(root->checkSanity());
+
+    KDDW_TEST_RETURN(true);
+}
+
+KDDW_QCORO_TASK tst_sanityCheckPolicy()
+{
+    DeleteViews deleteViews;
+
+    auto root = createRoot();
+    auto item1 = createItem();
+    root->insertItem(item1, Location_OnLeft);
+    CHECK(root->checkSanity());
+
+    Config &config = Config::self();
+    config.resetSanityCheckViolations();
+    CHECK_EQ(Item::numSanityViolations(), 0);
+
+    // Whole layout checks are sampled
+    config.setSanityCheckPolicy(SanityCheckPolicy::Sampled, 3);
+    CHECK(config.sanityCheckPolicy() == SanityCheckPolicy::Sampled);
+    CHECK_EQ(config.sanityCheckSampleInterval(), 3);
+    int numChecks = 0;
+    for (int i = 0; i < 9; ++i) {
+        if (Item::shouldCheckLayoutSanity())
+            ++numChecks;
+    }
+    CHECK_EQ(numChecks, 3);
+
+    // But cheap checks still run and violations are counted
+    const Rect geo = item1->geometry();
+    {
+        SetExpectedWarning w("Constraints not honoured");
+        item1->setGeometry(Rect(geo.topLeft(), Size(1, 1)));
+    }
+    CHECK_EQ(config.numSanityCheckViolations(), 1);
+    item1->setGeometry(geo);
+
+    // Nothing is checked
+    config.setSanityCheckPolicy(SanityCheckPolicy::Off);
+    CHECK(!Item::shouldCheckLayoutSanity());
+    item1->setGeometry(Rect(geo.topLeft(), Size(1, 1)));
+    CHECK_EQ(config.numSanityCheckViolations(), 1);
+    item1->setGeometry(geo);
+
+    config.setSanityCheckPolicy(SanityCheckPolicy::Full);
+    CHECK(Item::shouldCheckLayoutSanity());
+    config.resetSanityCheckViolations();
+    CHECK_EQ(config.numSanityCheckViolations(), 0);
+    CHECK(root->checkSanity());
+
+    KDDW_TEST_RETURN(true);
+}
+
+KDDW_QCORO_TASK tst_separatorsFollowMovedContainer()
+{
+    // Tests that when a nested container moves, its separators move with it, even though its
+    // own children didn't change
+
+    // Result [1, |2  |]
+    //            |2.1|
+    DeleteViews deleteViews;
+    auto root = createRoot();
+    auto item1 = createItem();
+    auto item2 = createItem();
+    auto item21 = createItem();
+    root->insertItem(item1, Location_OnLeft);
+    root->insertItem(item2, Location_OnRight);
+    ItemBoxContainer::insertItemRelativeTo(item21, item2, Location_OnBottom);
+
+    auto container2 = item2->parentBoxContainer();
+    CHECK(container2 != root.get());
+    CHECK(separatorsAreInPlace(root.get()));
+
+    // Moving root's separator moves container2
+    const int oldX = container2->x();
+    root->requestSeparatorMove(root->separators().constFirst(), -50);
+    CHECK_EQ(container2->x(), oldX - 50);
+    CHECK(separatorsAreInPlace(root.get()));
+
+    // Inserting on the left moves it too
+    auto item0 = createItem();
+    root->insertItem(item0, Location_OnLeft);
+    CHECK(separatorsAreInPlace(root.get()));
+
+    // And so does resizing the whole layout
+    root->setSize_recursive(root->size() + Size(100, 50));
+    CHECK(separatorsAreInPlace(root.get()));
+
+    CHECK(root->checkSanity());
+
+    KDDW_TEST_RETURN(true);
+}
+
+KDDW_QCORO_TASK tst_separatorsAfterGrandchildVisibility()
+{
+    // Tests that hiding and showing an item deep in the layout repositions the separators of its
+    // container and of the containers above it
+
+    // Result [1, |2      |]
+    //            |3  | 4 |
+    DeleteViews deleteViews;
+    auto root = createRoot();
+    auto item1 = createItem();
+    auto item2 = createItem();
+    auto item3 = createItem();
+    auto item4 = createItem();
+    root->insertItem(item1, Location_OnLeft);
+    root->insertItem(item2, Location_OnRight);
+    ItemBoxContainer::insertItemRelativeTo(item3, item2, Location_OnBottom);
+    ItemBoxContainer::insertItemRelativeTo(item4, item3, Location_OnRight);
+
+    auto container34 = item4->parentBoxContainer();
+    CHECK(container34->parentBoxContainer() != root.get());
+    CHECK_EQ(container34->separators().size(), 1);
+    CHECK(separatorsAreInPlace(root.get()));
+
+    auto guest4 = item4->guest();
+    item4->turnIntoPlaceholder();
+    CHECK_EQ(container34->separators().size(), 0);
+    CHECK(separatorsAreInPlace(root.get()));
+
+    item4->restore(guest4);
+    CHECK_EQ(container34->separators().size(), 1);
+    CHECK(separatorsAreInPlace(root.get()));
+
+    // Hiding both hides their container, so its parent loses a separator
+    auto guest3 = item3->guest();
+    item3->turnIntoPlaceholder();
+    item4->turnIntoPlaceholder();
+    CHECK_EQ(container34->numVisibleChildren(), 0);
+    CHECK_EQ(root->separators_recursive().size(), 1);
+    CHECK(separatorsAreInPlace(root.get()));
+
+    item3->restore(guest3);
+    CHECK_EQ(root->separators_recursive().size(), 2);
+    CHECK(separatorsAreInPlace(root.get()));
+
+    CHECK(root->checkSanity());
+
+    KDDW_TEST_RETURN(true);
+}
+
+KDDW_QCORO_TASK tst_separatorsRaisedAfterSetGuest()
+{
+    // Tests that giving an existing item a new guest keeps separators in place and on top of it,
+    // as the new guest's view is stacked above everything when it joins the layout
+    DeleteViews deleteViews;
+    auto root = createRoot();
+    auto item1 = createItem();
+    auto item2 = createItem();
+    auto item3 = createItem();
+    root->insertItem(item1, Location_OnLeft);
+    root->insertItem(item2, Location_OnRight);
+    root->insertItem(item3, Location_OnBottom);
+    CHECK(separatorsAreInPlace(root.get()));
+
+    item2->turnIntoPlaceholder();
+    Guest *newGuest = createGuest(QStringLiteral("newGuest"));
+    item2->restore(newGuest);
+    CHECK_EQ(item2->guest(), newGuest);
+    CHECK(separatorsAreInPlace(root.get()));
+
+    // Only QtWidgets reorders sibling views when raising
+    if (Platform::instance()->isQtWidgets()) {
+        int guestIndex = -1;
+        int lowestSeparatorIndex = -1;
+        const auto children = newGuest->m_view->parentView()->childViews();
+        for (int i = 0; i < children.size(); ++i) {
+            if (children.at(i)->equals(newGuest->m_view))
+                guestIndex = i;
+            else if (lowestSeparatorIndex == -1 && children.at(i)->is(ViewType::Separator))
+                lowestSeparatorIndex = i;
+        }
+
+        CHECK(guestIndex != -1);
+        CHECK(lowestSeparatorIndex > guestIndex);
+    }
+
+    CHECK(root->checkSanity());
+
+    KDDW_TEST_RETURN(true);
+}
+
 static const std::vector<KDDWTest> s_tests = {
     TEST(tst_createRoot),
     TEST(tst_insertOne),
@@ -2373,6 +2672,11 @@ static const std::vector<KDDWTest> s_tests = {
     TEST(tst_outermostNeighbor),
     TEST(tst_relativeToHidden),
     TEST(tst_spuriousResize),
+    TEST(tst_layoutTransaction),
+    TEST(tst_sanityCheckPolicy),
+    TEST(tst_separatorsFollowMovedContainer),
+    TEST(tst_separatorsAfterGrandchildVisibility),
+    TEST(tst_separatorsRaisedAfterSetGuest),
 };
 
 #include "tests_main.h"
@@ -82,6 +82,8 @@ struct EnsureTopLevelsDeleted
         , m_originalMDIFlags(Config::self().mdiFlags())
         , m_originalInternalFlags(Config::self().internalFlags())
         , m_originalSeparatorThickness(Config::self().separatorThickness())
+        , m_originalSeparatorMoveInterval(Config::self().separatorMoveInterval())
+        , m_originalDropIndicatorType(Core::ViewFactory::s_dropIndicatorType)
     {
     }
 
@@ -109,6 +111,8 @@ struct EnsureTopLevelsDeleted
         Config::self().setFlags(m_originalFlags);
         Config::self().setMDIFlags(m_originalMDIFlags);
         Config::self().setSeparatorThickness(m_originalSeparatorThickness);
+        Config::self().setSeparatorMoveInterval(m_originalSeparatorMoveInterval);
+        Core::ViewFactory::s_dropIndicatorType = m_originalDropIndicatorType;
         Config::self().setLayoutSaverStrictMode(false);
         InitialOption::s_defaultNeighbourSqueezeStrategy = NeighbourSqueezeStrategy::AllNeighbours;
     }
@@ -117,6 +121,8 @@ struct EnsureTopLevelsDeleted
     const Config::MDIFlags m_originalMDIFlags;
     const Config::InternalFlags m_originalInternalFlags;
     const int m_originalSeparatorThickness;
+    const int m_originalSeparatorMoveInterval;
+    const DropIndicatorType m_originalDropIndicatorType;
 };
 
 bool shouldBlacklistWarning(const QString &msg, const QString &category = {});
@@ -0,0 +1,231 @@
+/*
+  This file is part of KDDockWidgets.
+
+  SPDX-FileCopyrightText: 2024 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+/// Helpers for the benchmarks and the fuzzer, which exercise the layouting engine without a
+/// frontend: Dummy layouting host, guest and separator, an allocation counter and a helper to
+/// run and print benchmarks. Tests with a frontend can use the allocation counter too.
+///
+/// To count allocations, define KDDW_TESTS_COUNT_ALLOCATIONS before including this header. That
+/// replaces the global operator new, so do it in a single file per executable.
+
+#pragma once
+
+#include "core/layouting/Item_p.h"
+#include "core/layouting/LayoutingHost_p.h"
+#include "core/layouting/LayoutingGuest_p.h"
+#include "core/layouting/LayoutingSeparator_p.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <string>
+
+namespace KDDockWidgets {
+
+namespace Tests {
+
+/// The number of heap allocations done by the current thread, including the ones done inside the
+/// kddockwidgets library. Stays 0 unless KDDW_TESTS_COUNT_ALLOCATIONS is defined.
+inline thread_local uint64_t s_numAllocations = 0;
+
+class DummyHost : public Core::LayoutingHost
+{
+public:
+    bool supportsHonouringLayoutMinSize() const override
+    {
+        return true;
+    }
+};
+
+class DummySeparator : public Core::LayoutingSeparator
+{
+public:
+    using Core::LayoutingSeparator::LayoutingSeparator;
+
+    Rect geometry() const override
+    {
+        return m_geometry;
+    }
+
+    void setGeometry(Rect r) override
+    {
+        m_geometry = r;
+    }
+
+    Rect m_geometry;
+};
+
+/// A guest whose min size is Item::hardcodedMinimumSize
+class DummyGuest : public Core::LayoutingGuest
+{
+public:
+    explicit DummyGuest(const QString &id, Rect geometry = {})
+        : m_id(id)
+        , m_geometry(geometry)
+    {
+    }
+
+    ~DummyGuest() override
+    {
+        beingDestroyed.emit();
+    }
+
+    Size minSize() const override
+    {
+        return Core::Item::hardcodedMinimumSize;
+    }
+
+    Size maxSizeHint() const override
+    {
+        return Core::Item::hardcodedMaximumSize;
+    }
+
+    void setGeometry(Rect r) override
+    {
+        m_geometry = r;
+    }
+
+    void setVisible(bool is) override
+    {
+        m_isVisible = is;
+    }
+
+    Rect geometry() const override
+    {
+        return m_geometry;
+    }
+
+    void setHost(Core::LayoutingHost *host) override
+    {
+        m_host = host;
+    }
+
+    Core::LayoutingHost *host() const override
+    {
+        return m_host;
+    }
+
+    QString id() const override
+    {
+        return m_id;
+    }
+
+    const QString m_id;
+    Core::LayoutingHost *m_host = nullptr;
+    Rect m_geometry;
+    bool m_isVisible = false;
+};
+
+/// Runs benchmarks and prints a line per benchmark, with ns/op and allocations/op
+class Benchmark
+{
+public:
+    /// @p countName is the header of the column saying how big the benchmark was,
+    /// for example "items"
+    explicit Benchmark(bool smoke, const char *countName)
+        : m_smoke(smoke)
+        , m_countName(countName)
+    {
+    }
+
+    /// Runs @p op repeatedly until we have enough samples. @p op returns the number of
+    /// operations it did, so per-op numbers can be calculated, or 0 on failure.
+    /// @p setup, if set, is called before each run of @p op and is not accounted for.
+    bool run(const std::string &name, int count, const std::function<void()> &setup,
+             const std::function<uint64_t()> &op)
+    {
+        using namespace std::chrono;
+        const auto minDuration = m_smoke ? milliseconds(0) : milliseconds(200);
+        const int maxRuns = m_smoke ? 1 : 1000;
+
+        uint64_t numOps = 0;
+        nanoseconds elapsed(0);
+        uint64_t allocations = 0;
+        for (int i = 0; i < maxRuns && (i == 0 || elapsed < minDuration); ++i) {
+            if (setup)
+                setup();
+
+            const uint64_t allocationsBefore = s_numAllocations;
+            const auto start = steady_clock::now();
+            const uint64_t ops = op();
+            elapsed += steady_clock::now() - start;
+            allocations += s_numAllocations - allocationsBefore;
+
+            if (ops == 0) {
+                std::fprintf(stderr, "%s failed\n", name.c_str());
+                return false;
+            }
+
+            numOps += ops;
+        }
+
+        const double ops = double(std::max<uint64_t>(1, numOps));
+        std::printf("%-32s %8d %10llu %14.1f %12.1f\n", name.c_str(), count,
+                    static_cast<unsigned long long>(numOps), double(elapsed.count()) / ops,
+                    double(allocations) / ops);
+        std::fflush(stdout);
+        return true;
+    }
+
+    void printHeader() const
+    {
+        std::printf("%-32s %8s %10s %14s %12s\n", "benchmark", m_countName, "ops", "ns/op",
+                    "allocs/op");
+    }
+
+private:
+    const bool m_smoke;
+    const char *const m_countName;
+};
+
+}
+
+}
+
+#ifdef KDDW_TESTS_COUNT_ALLOCATIONS
+
+void *operator new(std::size_t size)
+{
+    ++KDDockWidgets::Tests::s_numAllocations;
+    if (void *ptr = std::malloc(size == 0 ? 1 : size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+#endif